@@ -1,187 +1,304 @@
 #include "Audio.h"
 
-#include <fstream>
-
-#include "Error.h"
-#include "Globals.h"
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <utility>
+#include <vector>
+
+#ifdef SQUAD_READY_SOUNDS_PCM
+#include "EmbeddedSounds.h"
+#elif defined(_WIN32)
 #include "resource.h"
+#endif
+
+AudioPlayer::AudioPlayer(Metrics& metrics, AudioOptions options)
+    : metrics_(metrics),
+      headless_(options.headless),
+      devices_(options.headless ? std::optional<AudioDevices::Rendered>(
+                                      std::move(options.rendered))
+                                : std::nullopt) {
+  if (!options.pcm_cache_path.empty()) {
+    pcm_cache_.emplace(std::move(options.pcm_cache_path), kPcmCacheMaxBytes);
+  }
+}
 
 AudioPlayer::~AudioPlayer() {
   Destroy();
 }
 
-bool AudioPlayer::Init(std::string ready_check_path, int ready_check_volume,
-                       std::string squad_ready_path, int squad_ready_volume,
-                       const std::optional<std::string>& preferred_device_name) {
-  bool success = true;
+bool AudioPlayer::Init(const AudioConfig& config) {
+  Configure(config);
+  if (!InitContext()) return false;
+  if (!OpenOutputDevice()) return false;
+  if (!InitEngine()) return false;
+  return LoadSounds();
+}
 
-  ready_check_path_ = ready_check_path;
-  squad_ready_path_ = squad_ready_path;
-  preferred_device_name_ = preferred_device_name;
-  output_devices_ = std::vector<std::string>();
+void AudioPlayer::Configure(const AudioConfig& config) {
+  bindings_ = config.bindings;
+  preferred_device_name_ = config.output_device;
+  normalize_volume_ = config.normalize_volume;
+}
 
+bool AudioPlayer::InitContext() {
+  // headless, the null backend keeps miniaudio off the sound card
+  ma_backend null_backend = ma_backend_null;
   context_ = std::make_unique<ma_context>();
-  if (const auto result = ma_context_init(nullptr, 0, nullptr, context_.get());
+  if (const auto result =
+          ma_context_init(headless_ ? &null_backend : nullptr,
+                          headless_ ? 1 : 0, nullptr, context_.get());
       result != MA_SUCCESS) {
     logging::MiniAudioError(result, "Failed to initialize audio context");
+    context_.reset();
     return false;
   }
+  return true;
+}
 
-  UpdateOutputDevices();
+bool AudioPlayer::OpenOutputDevice() {
+  return devices_.Open(context_.get(), preferred_device_name_.value_or(
+                                           AudioDevices::kDefault));
+}
 
+std::unique_ptr<ma_engine> AudioPlayer::CreateEngine(
+    const AudioDevices::Format format) {
+  // renders into devices_ rather than a device of its own, so the device can
+  // change under it
   auto engine_config = ma_engine_config_init();
   engine_config.pContext = context_.get();
-  engine_config.pPlaybackDeviceID =
-      GetOutputDeviceIdByName(preferred_device_name.value_or("Default"));
-  engine_ = std::make_unique<ma_engine>();
-  if (const auto result = ma_engine_init(&engine_config, engine_.get());
+  engine_config.noDevice = MA_TRUE;
+  engine_config.channels = format.channels;
+  engine_config.sampleRate = format.sample_rate;
+  auto engine = std::make_unique<ma_engine>();
+  if (const auto result = ma_engine_init(&engine_config, engine.get());
       result != MA_SUCCESS) {
     logging::MiniAudioError(result, "Failed to initialize audio engine");
-    return false;
+    return nullptr;
   }
+  return engine;
+}
 
-  if (!UpdateReadyCheck(ready_check_path)) {
-    logging::Squad(std::format("Failed to load ready check audio from {}: {}",
-                               ready_check_path, ready_check_status_));
-    success = false;
-  }
-  UpdateReadyCheckVolume(ready_check_volume);
+bool AudioPlayer::InitEngine() {
+  engine_ = CreateEngine({devices_.Channels(), devices_.SampleRate()});
+  if (!engine_) return false;
+  if (!devices_.Start(engine_.get())) return false;
+  engine_ready_.store(true, std::memory_order_release);
+  return true;
+}
 
-  if (!UpdateSquadReady(squad_ready_path)) {
-    logging::Squad(std::format("Failed to load squad ready audio from {}: {}",
-                               squad_ready_path, squad_ready_status_));
-    success = false;
+bool AudioPlayer::LoadSounds() {
+  bank_.Bind(bindings_, Loader(engine_.get()));
+  bool success = true;
+  for (size_t i = 0; i < kSoundEvents; i++) {
+    const auto event = static_cast<SoundEvent>(i);
+    const auto sound = bank_.Get(event);
+    if (sound && !sound->IsValid()) {
+      logging::Squad("Failed to load {} audio from {}: {}",
+                     SoundEventName(event), bank_.Binding(event).key,
+                     sound->ErrorMessage());
+      success = false;
+    }
   }
-  UpdateSquadReadyVolume(squad_ready_volume);
-
+  sounds_version_.fetch_add(1, std::memory_order_release);
   return success;
 }
 
 bool AudioPlayer::ReInit() {
   Destroy();
-  return Init(ready_check_path_, ready_check_volume_, squad_ready_path_,
-              squad_ready_volume_, preferred_device_name_);
+  if (!InitContext()) return false;
+  if (!OpenOutputDevice()) return false;
+  if (!InitEngine()) return false;
+  return LoadSounds();
 }
 
-bool AudioPlayer::UpdateReadyCheck(const std::string& path) {
-  if (path.empty()) {
-    logging::Debug("loading default ready check");
-    ready_check_sound_ =
-        std::make_unique<WaveFile>(MAKEINTRESOURCE(READY_CHECK), engine_.get());
-  } else {
-    ready_check_sound_ = std::make_unique<WaveFile>(path, engine_.get());
-  }
-  const bool success = ready_check_sound_->IsValid();
-  if (!success) {
-    logging::Debug("failed to load ready check");
-    ready_check_status_ = ready_check_sound_->ErrorMessage();
+std::shared_ptr<WaveFile> AudioPlayer::LoadSound(const std::string& key,
+                                                 ma_engine* engine) {
+  const ScopedTimer timer(metrics_, Metric::SoundLoad);
+  logging::Debug("loading sound {}", key);
+  std::shared_ptr<WaveFile> sound;
+  if (key == kBundledReadyCheck) {
+#ifdef SQUAD_READY_SOUNDS_PCM
+    sound = std::make_shared<WaveFile>(embedded_sounds::kReadyCheck,
+                                       engine);
+#elif defined(_WIN32)
+    sound = std::make_shared<WaveFile>(MAKEINTRESOURCE(READY_CHECK),
+                                       engine);
+#else
+    sound = std::make_shared<WaveFile>("Not bundled in this build");
+#endif
+  } else if (key == kBundledSquadReady) {
+#ifdef SQUAD_READY_SOUNDS_PCM
+    sound = std::make_shared<WaveFile>(embedded_sounds::kSquadReady,
+                                       engine);
+#elif defined(_WIN32)
+    sound = std::make_shared<WaveFile>(MAKEINTRESOURCE(SQUAD_READY),
+                                       engine);
+#else
+    sound = std::make_shared<WaveFile>("Not bundled in this build");
+#endif
   } else {
-    ready_check_status_ = "";
+    sound = std::make_shared<WaveFile>(
+        key, engine, pcm_cache_ ? &*pcm_cache_ : nullptr);
   }
-  UpdateReadyCheckVolume(ready_check_volume_);
-  return success;
+  if (!sound->IsValid()) logging::Debug("failed to load {}", key);
+  return sound;
 }
 
-bool AudioPlayer::UpdateSquadReady(const std::string& path) {
-  if (path.empty()) {
-    logging::Debug("loading default squad ready");
-    squad_ready_sound_ =
-        std::make_unique<WaveFile>(MAKEINTRESOURCE(SQUAD_READY), engine_.get());
-  } else {
-    squad_ready_sound_ = std::make_unique<WaveFile>(path, engine_.get());
-  }
-  const bool success = squad_ready_sound_->IsValid();
-  if (!success) {
-    logging::Debug("failed to load squad ready");
-    squad_ready_status_ = squad_ready_sound_->ErrorMessage();
-  } else {
-    squad_ready_status_ = "";
+bool AudioPlayer::ReloadSound(const SoundEvent event) {
+  if (!engine_) return false;
+  bank_.Reload(bank_.Binding(event).key, Loader(engine_.get()));
+  sounds_version_.fetch_add(1, std::memory_order_release);
+  const auto sound = bank_.Get(event);
+  return sound && sound->IsValid();
+}
+
+void AudioPlayer::Update() {
+  if (reformatting_.valid()) {
+    if (reformatting_.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      return;
+    }
+    SwapMix(reformatting_.get());
   }
-  UpdateSquadReadyVolume(squad_ready_volume_);
-  return success;
+  const auto format = devices_.TakeFormatChange();
+  if (!format) return;
+  logging::Debug("output device format changed, converting sounds");
+  reformatting_ = std::async(std::launch::async,
+                             [this, format = *format, bindings = bindings_] {
+                               return BuildMix(format, bindings);
+                             });
 }
 
-void AudioPlayer::UpdateReadyCheckVolume(const int volume) {
-  ready_check_volume_ = volume;
-  if (!ready_check_sound_) return;
-  ready_check_sound_->SetVolume(volume);
+AudioPlayer::Mix::~Mix() {
+  // sounds go before the engine they play through
+  bank.Clear();
+  if (engine) ma_engine_uninit(engine.get());
 }
 
-void AudioPlayer::UpdateSquadReadyVolume(const int volume) {
-  squad_ready_volume_ = volume;
-  if (!squad_ready_sound_) return;
-  squad_ready_sound_->SetVolume(volume);
+std::unique_ptr<AudioPlayer::Mix> AudioPlayer::BuildMix(
+    const AudioDevices::Format format, SoundBindings bindings) {
+  auto mix = std::make_unique<Mix>();
+  mix->format = format;
+  mix->bindings = std::move(bindings);
+  mix->engine = CreateEngine(format);
+  if (!mix->engine) return nullptr;
+  mix->bank.Bind(mix->bindings, Loader(mix->engine.get()));
+  return mix;
+}
+
+void AudioPlayer::SwapMix(std::unique_ptr<Mix> mix) {
+  // keeps playing through the old engine, converted by the device
+  if (!mix) return;
+  // the settings changed while converting, only changed keys load here
+  if (mix->bindings != bindings_) {
+    mix->bank.Bind(bindings_, Loader(mix->engine.get()));
+  }
+  std::swap(engine_, mix->engine);
+  std::swap(bank_, mix->bank);
+  sounds_version_.fetch_add(1, std::memory_order_release);
+  const auto format = mix->format;
+  // the device thread frees the old engine and its sounds once it stops
+  // rendering them
+  devices_.ChangeEngine(engine_.get(), format,
+                        std::shared_ptr<Mix>(std::move(mix)));
 }
 
 void AudioPlayer::UpdateOutputDevice(const std::string& device_name) {
   preferred_device_name_ = device_name;
+  devices_.Switch(device_name);
 }
 
-ma_device_id* AudioPlayer::GetOutputDeviceIdByName(
-    const std::string& device_name) const {
-  ma_device_info* playback_device_infos;
-  ma_uint32 playback_device_count;
-  
-  if (const auto result =
-          ma_context_get_devices(context_.get(), &playback_device_infos,
-                                 &playback_device_count, nullptr, nullptr);
-      result != MA_SUCCESS) {
-    logging::MiniAudioError(result, "Failed to retrieve device list");
-    return nullptr;
+void AudioPlayer::ApplyConfig(const AudioConfig& config) {
+  if (config.output_device != preferred_device_name_) {
+    UpdateOutputDevice(config.output_device.value_or(AudioDevices::kDefault));
+    preferred_device_name_ = config.output_device;
   }
-
-  for (ma_uint32 i_device = 0; i_device < playback_device_count; ++i_device) {
-    if (device_name == playback_device_infos[i_device].name) {
-      return &playback_device_infos[i_device].id;
-    }
+  normalize_volume_ = config.normalize_volume;
+  // sounds still bound keep playing from the same asset, only new keys load
+  if (config.bindings != bindings_) {
+    bindings_ = config.bindings;
+    if (engine_) bank_.Bind(bindings_, Loader(engine_.get()));
+    sounds_version_.fetch_add(1, std::memory_order_release);
   }
-
-  // Device not found, log and return false
-  logging::Squad(
-      std::format("Audio output device '{}' not found", device_name));
-  return nullptr;
 }
 
-bool AudioPlayer::UpdateOutputDevices() {
-  ma_device_info* playback_device_infos;
-  ma_uint32 playback_device_count;
-
-  if (const auto result =
-          ma_context_get_devices(context_.get(), &playback_device_infos,
-                                 &playback_device_count, nullptr, nullptr);
-      result != MA_SUCCESS) {
-    logging::MiniAudioError(result, "Failed to retrieve device list");
-    return false;
-  }
-
-  std::vector<std::string> device_names;
-  device_names.emplace_back("Default");
+void AudioPlayer::Advance(const std::chrono::nanoseconds duration) {
+  if (headless_) devices_.Advance(duration);
+}
 
-  for (ma_uint32 i_device = 0; i_device < playback_device_count; ++i_device) {
-    device_names.emplace_back(playback_device_infos[i_device].name);
-  }
+void AudioPlayer::RefreshOutputDevices() { devices_.Refresh(); }
 
-  output_devices_ = std::move(device_names);
+std::vector<std::string> AudioPlayer::OutputDevices() {
+  return devices_.Get()->names;
+}
 
-  return true;
+std::string AudioPlayer::SoundStatus(const SoundEvent event) {
+  const auto sound = bank_.Get(event);
+  if (!sound || sound->IsValid()) return "";
+  return sound->ErrorMessage();
 }
 
-std::vector<std::string> AudioPlayer::OutputDevices() {
-  return output_devices_;
+std::string AudioPlayer::SoundMemory(const SoundEvent event) {
+  const auto sound = bank_.Get(event);
+  if (!sound || !sound->IsValid()) return "";
+  return sound->MemoryDescription();
 }
 
+std::string AudioPlayer::SoundLevels(const SoundEvent event) {
+  const auto sound = bank_.Get(event);
+  if (!sound || !sound->IsValid() || !sound->Analyzed()) return "";
+  const float gain_db = 20.0f * std::log10(sound->NormalizationGain());
+  if (sound->TrimmedMilliseconds() < 1.0f) {
+    return std::format("{:+.1f} dB", gain_db);
+  }
+  return std::format("{:.0f}ms silence trimmed, {:+.1f} dB",
+                     sound->TrimmedMilliseconds(), gain_db);
+}
 
-std::string AudioPlayer::ReadyCheckStatus() { return ready_check_status_; }
+std::string AudioPlayer::SoundPlayback(const SoundEvent event) {
+  const auto sound = bank_.Get(event);
+  if (!sound) return "no sound";
+  if (!sound->IsValid()) return "not loaded";
+  const auto latency = sound->Latency();
+  if (latency.count == 0) {
+    return std::format("{} voices, not played yet", sound->Voices());
+  }
+  return std::format(
+      "{} voices, {} steals, played {}x, trigger to mix last {:.1f}ms "
+      "mean {:.1f}ms max {:.1f}ms",
+      sound->Voices(), sound->Steals(), latency.count,
+      latency.last.count() / 1000.0, latency.mean.count() / 1000.0,
+      latency.max.count() / 1000.0);
+}
 
-std::string AudioPlayer::SquadReadyStatus() { return squad_ready_status_; }
+std::string AudioPlayer::SoundBankSummary() {
+  size_t sounds = 0;
+  uint64_t bytes = 0;
+  bank_.ForEachAsset([&](const std::string&, const WaveFile& sound) {
+    sounds++;
+    bytes += sound.ResidentBytes();
+  });
+  size_t events = 0;
+  for (size_t i = 0; i < kSoundEvents; i++) {
+    if (bank_.Get(static_cast<SoundEvent>(i))) events++;
+  }
+  return std::format("{} sounds for {} events, {}", sounds, events,
+                     FormatBytes(bytes));
+}
 
 std::string AudioPlayer::OutputDeviceName() {
-  return ma_engine_get_device(engine_.get())->playback.name;
+  if (!engine_) return "None";
+  return devices_.Get()->current;
 }
 
 void AudioPlayer::Destroy() {
-  ready_check_sound_.reset();
-  squad_ready_sound_.reset();
+  engine_ready_.store(false, std::memory_order_release);
+  // waits for any conversion, its engine uses context_
+  reformatting_ = {};
+  bank_.Clear();
+  sounds_version_.fetch_add(1, std::memory_order_release);
+  devices_.Close();
   if (engine_) {
     ma_engine_uninit(engine_.get());
     engine_.reset();
@@ -192,124 +309,12 @@ void AudioPlayer::Destroy() {
   }
 }
 
-void AudioPlayer::PlayReadyCheck() const {
-  logging::Debug("playing ready check");
-  if (!engine_) return;
-  if (!ready_check_sound_) return;
-  ready_check_sound_->Play();
-}
-
-void AudioPlayer::PlaySquadReady() const {
-  logging::Debug("playing squad ready");
+void AudioPlayer::Play(const SoundEvent event) const {
+  const ScopedTimer timer(metrics_, Metric::SoundPlay);
+  logging::Debug("playing {}", SoundEventName(event));
   if (!engine_) return;
-  if (!squad_ready_sound_) return;
-  squad_ready_sound_->Play();
-}
-
-WaveFile::WaveFile() {
-  valid_ = false;
-  buffer_ = nullptr;
-}
-
-WaveFile::WaveFile(const std::string& file_name, ma_engine* engine) {
-  valid_ = false;
-  buffer_ = nullptr;
-  sound_ = std::make_unique<ma_sound>();
-  decoder_ = nullptr;
-
-  if (const auto result = ma_sound_init_from_file(engine, file_name.c_str(),
-                                                  MA_SOUND_FLAG_DECODE, nullptr,
-                                                  nullptr, sound_.get());
-      result != MA_SUCCESS) {
-    error_message_ =
-        std::format("Failed to load: {}", error::humanize_ma_result(result));
-    logging::MiniAudioError(result,
-                            std::format("Failed to load {}", file_name));
-    return;
-  }
-
-  valid_ = true;
-}
-
-WaveFile::WaveFile(LPWSTR resource, ma_engine* engine) {
-  valid_ = false;
-  buffer_ = nullptr;
-  sound_ = std::make_unique<ma_sound>();
-  decoder_ = std::make_unique<ma_decoder>();
-
-  const auto resource_info =
-      FindResource(globals::self_dll, resource, TEXT("WAVE"));
-  if (resource_info == nullptr) return;
-
-  const auto loaded_resource = LoadResource(globals::self_dll, resource_info);
-  if (loaded_resource == nullptr) return;
-
-  const auto resource_size = SizeofResource(globals::self_dll, resource_info);
-  if (resource_size == 0) return;
-
-  const auto resource_pointer = LockResource(loaded_resource);
-  if (resource_pointer == nullptr) return;
-
-  buffer_ = new char[resource_size];
-  memcpy(buffer_, resource_pointer, resource_size);
-
-  if (const auto decode_result = ma_decoder_init_memory(
-          buffer_, resource_size, nullptr, decoder_.get());
-      decode_result != MA_SUCCESS) {
-    error_message_ = std::format("Internal error, failed to init decoder: {}",
-                                 error::humanize_ma_result(decode_result));
-    logging::MiniAudioError(decode_result, "Failed to init decoder");
-    return;
-  }
-
-  if (const auto sound_init_result = ma_sound_init_from_data_source(
-          engine, decoder_.get(), MA_SOUND_FLAG_DECODE, nullptr, sound_.get());
-      sound_init_result != MA_SUCCESS) {
-    error_message_ = std::format("Internal error, failed to init sound: {}",
-                                 error::humanize_ma_result(sound_init_result));
-    logging::MiniAudioError(sound_init_result, "Failed to init sound");
-    return;
-  }
-
-  valid_ = true;
-}
-
-WaveFile::~WaveFile() {
-  logging::Debug("destroying wave file");
-  valid_ = false;
-  if (sound_) {
-    logging::Debug("stopping sound");
-    logging::MiniAudioError(ma_sound_stop(sound_.get()), "Failed to stop sound");
-    ma_sound_uninit(sound_.get());
-  }
-  if (decoder_) {
-    logging::Debug("uniniting decoder");
-    logging::MiniAudioError(ma_decoder_uninit(decoder_.get()), "Failed to uninit decoder");
-  }
-  delete[] buffer_;
-}
-
-void WaveFile::Play() const {
-  if (!valid_) {
-    logging::Debug("wave file is not valid, not playing");
-    return;
-  }
-  if (const auto engine = ma_sound_get_engine(sound_.get()); !engine) {
-    return;
-  }
-  if (const auto result = ma_sound_start(sound_.get()); result != MA_SUCCESS) {
-    logging::Debug("failed to play wave file");
-    logging::MiniAudioError(result, "Failed to play sound");
-  }
-}
-
-bool WaveFile::IsValid() const { return valid_; }
-
-std::string WaveFile::ErrorMessage() const { return error_message_; }
-
-
-void WaveFile::SetVolume(const int volume) const {
-  if (!valid_) return;
-  const float ratio = volume / 100.0f;
-  ma_sound_set_volume(sound_.get(), ratio);
+  const auto sound = bank_.Get(event);
+  if (!sound) return;
+  const float gain = bank_.Binding(event).gain;
+  sound->Play(normalize_volume_ ? gain * sound->NormalizationGain() : gain);
 }
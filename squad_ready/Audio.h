@@ -1,72 +1,153 @@
 #pragma once
 
-#include <Windows.h>
-
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "Logging.h"
+#include "WaveFile.h"
+#include "core/Metrics.h"
+#include "core/OptionsView.h"
+#include "core/SoundBank.h"
+#include "core/SoundLoadPolicy.h"
 #include "extension/Singleton.h"
 
 #define MINIAUDIO_IMPLEMENTATION
-#include <optional>
-
 #include "miniaudio/extras/miniaudio_split/miniaudio.h"
 
-class WaveFile {
- public:
-  WaveFile();
-  WaveFile(const std::string& file_name, ma_engine* engine);
-  WaveFile(LPWSTR resource, ma_engine* engine);
-  ~WaveFile();
-  void Play() const;
-  bool IsValid() const;
-  void SetVolume(int volume) const;
-  std::string ErrorMessage() const;
+#include "AudioDevices.h"
 
- private:
-  char* buffer_;
-  std::unique_ptr<ma_sound> sound_;
-  std::unique_ptr<ma_decoder> decoder_;
-  std::string error_message_ = "Unknown error";
-  bool valid_;
+const std::string kPcmCachePath = "addons\\arcdps\\arcdps_squad_ready_cache";
+constexpr uint64_t kPcmCacheMaxBytes = 64ull << 20;
+
+// Keys of the sounds embedded in the DLL, which can't clash with a path.
+constexpr char kBundledReadyCheck[] = "bundled:ready_check";
+constexpr char kBundledSquadReady[] = "bundled:squad_ready";
+
+// What the player takes from the settings, see ResolveAudioConfig.
+struct AudioConfig {
+  SoundBindings bindings;
+  std::optional<std::string> output_device;
+  bool normalize_volume = true;
+};
+
+// How the player runs, fixed for its lifetime. The plugin uses the defaults.
+struct AudioOptions {
+  // where decoded sounds are cached, nothing is cached if empty
+  std::filesystem::path pcm_cache_path = kPcmCachePath;
+  // Never opens a sound card or starts the device thread, only the offline
+  // outputs play, rendered by Advance on the caller's thread. For driving
+  // the player on a simulated clock.
+  bool headless = false;
+  // headless only, sees every block rendered
+  AudioDevices::Rendered rendered;
 };
 
-class AudioPlayer final : public Singleton<AudioPlayer, false> {
+class AudioPlayer final : public Singleton<AudioPlayer, false>,
+                          public AudioStatusSource {
  public:
-  AudioPlayer() = default;
+  // Sound loads and plays are timed in metrics.
+  explicit AudioPlayer(Metrics& metrics, AudioOptions options = {});
   ~AudioPlayer() override;
 
-  bool Init(std::string ready_check_path, int ready_check_volume,
-            std::string squad_ready_path, int squad_ready_volume,
-            const std::optional<std::string>& preferred_device_name);
+  bool Init(const AudioConfig& config);
   bool ReInit();
-  void PlayReadyCheck() const;
-  void PlaySquadReady() const;
-  bool UpdateReadyCheck(const std::string& path);
-  bool UpdateSquadReady(const std::string& path);
-  void UpdateReadyCheckVolume(int volume);
-  void UpdateSquadReadyVolume(int volume);
+  // The stages of Init, in order, for callers that run or time them
+  // separately.
+  void Configure(const AudioConfig& config);
+  bool InitContext();
+  bool OpenOutputDevice();
+  bool InitEngine();
+  // Loads every distinct sound the events use, in parallel. False if any
+  // failed.
+  bool LoadSounds();
+  void Play(SoundEvent event) const;
+  // Loads the event's sound again, for every event sharing it. True if it
+  // loaded.
+  bool ReloadSound(SoundEvent event);
+  // Called every frame. After switching to an output device with another
+  // format, converts the sounds to it on a worker thread and swaps them in
+  // once done, so they are converted once instead of on every callback.
+  void Update();
+  // Switches on the device thread, loaded sounds carry over unless the new
+  // device has a different format, see Update.
   void UpdateOutputDevice(const std::string& device_name);
-  ma_device_id* GetOutputDeviceIdByName(const std::string& device_name) const;
-  bool UpdateOutputDevices();
-  std::vector<std::string> OutputDevices();
-  std::string ReadyCheckStatus();
-  std::string SquadReadyStatus();
-  std::string OutputDeviceName();
+  // Settings subscriber, applies whatever changed since the last config.
+  void ApplyConfig(const AudioConfig& config);
+  // Headless only. Renders duration of audio into the offline output, and
+  // first does any device work queued since the last call.
+  void Advance(std::chrono::nanoseconds duration);
+  // Re-enumerates on the device thread, OutputDevices updates once done.
+  void RefreshOutputDevices();
+  std::vector<std::string> OutputDevices() override;
+  // Why the event's sound failed to load, empty if it didn't.
+  std::string SoundStatus(SoundEvent event) override;
+  std::string SoundMemory(SoundEvent event) override;
+  // Silence trimmed and loudness gain, empty if the sound wasn't analyzed.
+  std::string SoundLevels(SoundEvent event) override;
+  // Voices, steals and trigger to first read latency, for the debug window.
+  std::string SoundPlayback(SoundEvent event);
+  // Distinct sounds loaded and the memory they hold, for the debug window.
+  std::string SoundBankSummary();
+  std::string OutputDeviceName() override;
+  // Any thread. The engine is running, false until Init or ReInit gets that
+  // far and after either fails.
+  bool EngineReady() const {
+    return engine_ready_.load(std::memory_order_acquire);
+  }
+  // Any thread. Changes whenever what the getters above return might have,
+  // so the options panel only asks again then.
+  uint64_t Version() const {
+    return sounds_version_.load(std::memory_order_acquire) +
+           devices_.Version();
+  }
 
  private:
+  // An engine and the sounds loaded for it, at another output format.
+  struct Mix {
+    ~Mix();
+
+    AudioDevices::Format format;
+    SoundBindings bindings;
+    std::unique_ptr<ma_engine> engine;
+    SoundBank<WaveFile> bank;
+  };
+
   void Destroy();
+  std::unique_ptr<ma_engine> CreateEngine(AudioDevices::Format format);
+  // Runs on a worker thread, touches nothing the render thread uses. Null if
+  // the engine failed to initialize.
+  std::unique_ptr<Mix> BuildMix(AudioDevices::Format format,
+                                SoundBindings bindings);
+  void SwapMix(std::unique_ptr<Mix> mix);
+  // Loads a bundled sound or a file, playing through engine.
+  std::shared_ptr<WaveFile> LoadSound(const std::string& key,
+                                      ma_engine* engine);
+  SoundBank<WaveFile>::Loader Loader(ma_engine* engine) {
+    return [this, engine](const std::string& key) {
+      return LoadSound(key, engine);
+    };
+  }
 
-  std::unique_ptr<WaveFile> ready_check_sound_;
-  int ready_check_volume_;
-  std::string ready_check_path_;
-  std::unique_ptr<WaveFile> squad_ready_sound_;
-  int squad_ready_volume_;
-  std::string squad_ready_path_;
+  Metrics& metrics_;
+  bool headless_;
+  std::optional<PcmCache> pcm_cache_;
+  SoundBindings bindings_;
+  SoundBank<WaveFile> bank_;
+  bool normalize_volume_ = true;
+  // bumped whenever the bank or the engine changes
+  std::atomic<uint64_t> sounds_version_ = 0;
+  std::atomic<bool> engine_ready_ = false;
   std::optional<std::string> preferred_device_name_;
   std::unique_ptr<ma_context> context_;
   std::unique_ptr<ma_engine> engine_;
-  std::vector<std::string> output_devices_;
-  std::string ready_check_status_;
-  std::string squad_ready_status_;
+  // converting the sounds to the output device's new format
+  std::future<std::unique_ptr<Mix>> reformatting_;
+  AudioDevices devices_;
 };
@@ -0,0 +1,444 @@
+#include "AudioDevices.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <mmdeviceapi.h>
+#endif
+
+#include <algorithm>
+#include <format>
+#include <utility>
+
+#include "Logging.h"
+
+#ifdef _WIN32
+namespace {
+
+// Forwards Windows endpoint changes to the device thread. Called on COM
+// threads, so all it does is queue a refresh.
+class DeviceNotifications final : public IMMNotificationClient {
+ public:
+  explicit DeviceNotifications(AudioDevices& devices) : devices_(devices) {}
+
+  HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid,
+                                           void** object) override {
+    if (riid == __uuidof(IUnknown) ||
+        riid == __uuidof(IMMNotificationClient)) {
+      *object = static_cast<IMMNotificationClient*>(this);
+      AddRef();
+      return S_OK;
+    }
+    *object = nullptr;
+    return E_NOINTERFACE;
+  }
+  ULONG STDMETHODCALLTYPE AddRef() override { return ++references_; }
+  ULONG STDMETHODCALLTYPE Release() override {
+    const auto references = --references_;
+    if (references == 0) delete this;
+    return references;
+  }
+
+  HRESULT STDMETHODCALLTYPE OnDeviceStateChanged(LPCWSTR, DWORD) override {
+    devices_.Refresh();
+    return S_OK;
+  }
+  HRESULT STDMETHODCALLTYPE OnDeviceAdded(LPCWSTR) override {
+    devices_.Refresh();
+    return S_OK;
+  }
+  HRESULT STDMETHODCALLTYPE OnDeviceRemoved(LPCWSTR) override {
+    devices_.Refresh();
+    return S_OK;
+  }
+  HRESULT STDMETHODCALLTYPE OnDefaultDeviceChanged(const EDataFlow flow,
+                                                   const ERole role,
+                                                   LPCWSTR) override {
+    // miniaudio moves a default device over by itself, this just updates
+    // the names shown
+    if (flow == eRender && role == eConsole) devices_.Refresh();
+    return S_OK;
+  }
+  HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR,
+                                                   const PROPERTYKEY) override {
+    return S_OK;
+  }
+
+ private:
+  AudioDevices& devices_;
+  std::atomic<ULONG> references_ = 1;
+};
+
+}  // namespace
+#endif
+
+bool AudioDevices::Open(ma_context* context, const std::string& preferred) {
+  context_ = context;
+  preferred_ = preferred;
+  // let the first device pick the engine format
+  channels_ = 0;
+  sample_rate_ = 0;
+  if (!headless_) Enumerate();
+  if (!OpenDevice(preferred)) return false;
+  if (offline_) {
+    channels_ = offline_->Channels();
+    sample_rate_ = offline_->SampleRate();
+  } else {
+    channels_ = device_->playback.channels;
+    sample_rate_ = device_->sampleRate;
+  }
+  return true;
+}
+
+bool AudioDevices::Start(ma_engine* engine) {
+  engine_.store(engine, std::memory_order_release);
+  offline_rendered_at_ = Clock::now();
+  if (device_) {
+    if (const auto result = ma_device_start(device_.get());
+        result != MA_SUCCESS) {
+      logging::MiniAudioError(result, "Failed to start audio device");
+      return false;
+    }
+  }
+  if (!headless_) thread_ = std::thread(&AudioDevices::Run, this);
+  return true;
+}
+
+void AudioDevices::Close() {
+  if (thread_.joinable()) {
+    {
+      std::scoped_lock lock(mutex_);
+      stop_requested_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+  }
+  CloseDevice();
+  engine_.store(nullptr, std::memory_order_release);
+  entries_.clear();
+  std::scoped_lock lock(mutex_);
+  stop_requested_ = false;
+  refresh_requested_ = false;
+  switch_requested_.reset();
+  // nothing renders now, a previous engine never handed over can go
+  engine_change_requested_.reset();
+  changed_format_.reset();
+  format_changed_.store(false, std::memory_order_release);
+}
+
+void AudioDevices::Switch(const std::string& name) {
+  {
+    std::scoped_lock lock(mutex_);
+    switch_requested_ = name;
+  }
+  wake_.notify_one();
+}
+
+void AudioDevices::Refresh() {
+  {
+    std::scoped_lock lock(mutex_);
+    refresh_requested_ = true;
+  }
+  wake_.notify_one();
+}
+
+std::optional<AudioDevices::Format> AudioDevices::TakeFormatChange() {
+  if (!format_changed_.load(std::memory_order_acquire)) return std::nullopt;
+  std::scoped_lock lock(mutex_);
+  format_changed_.store(false, std::memory_order_release);
+  return std::exchange(changed_format_, std::nullopt);
+}
+
+void AudioDevices::ChangeEngine(ma_engine* engine, const Format format,
+                                std::shared_ptr<void> previous) {
+  {
+    std::scoped_lock lock(mutex_);
+    engine_change_requested_ =
+        EngineChange{engine, format, std::move(previous)};
+  }
+  wake_.notify_one();
+}
+
+void AudioDevices::Advance(const std::chrono::nanoseconds duration) {
+  std::unique_lock lock(mutex_);
+  Service(lock);
+  lock.unlock();
+  if (offline_ && engine_.load(std::memory_order_acquire)) {
+    offline_->Advance(duration);
+  }
+}
+
+void AudioDevices::DataCallback(ma_device* device, void* output, const void*,
+                                const ma_uint32 frame_count) {
+  const auto self = static_cast<AudioDevices*>(device->pUserData);
+  if (const auto engine = self->engine_.load(std::memory_order_acquire)) {
+    ma_engine_read_pcm_frames(engine, output, frame_count, nullptr);
+  }
+}
+
+void AudioDevices::Run() {
+#ifdef _WIN32
+  const bool com_initialized =
+      SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+  IMMDeviceEnumerator* enumerator = nullptr;
+  DeviceNotifications* notifications = nullptr;
+  if (com_initialized &&
+      SUCCEEDED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr,
+                                 CLSCTX_ALL, IID_PPV_ARGS(&enumerator)))) {
+    notifications = new DeviceNotifications(*this);
+    if (FAILED(enumerator->RegisterEndpointNotificationCallback(
+            notifications))) {
+      logging::Debug("failed to register for audio device changes");
+      notifications->Release();
+      notifications = nullptr;
+    }
+  }
+#endif
+
+  std::unique_lock lock(mutex_);
+  while (true) {
+    const auto requested = [this] {
+      return stop_requested_ || refresh_requested_ ||
+             switch_requested_.has_value() ||
+             engine_change_requested_.has_value();
+    };
+    // an offline output has no device pulling audio, so this thread does
+    if (offline_) {
+      wake_.wait_for(lock, kOfflinePeriod, requested);
+      lock.unlock();
+      AdvanceOffline();
+      lock.lock();
+    } else {
+      wake_.wait(lock, requested);
+    }
+    if (stop_requested_) break;
+    Service(lock);
+  }
+  lock.unlock();
+
+#ifdef _WIN32
+  if (notifications) {
+    enumerator->UnregisterEndpointNotificationCallback(notifications);
+    notifications->Release();
+  }
+  if (enumerator) enumerator->Release();
+  if (com_initialized) CoUninitialize();
+#endif
+}
+
+void AudioDevices::Service(std::unique_lock<std::mutex>& lock) {
+  if (!refresh_requested_ && !switch_requested_ && !engine_change_requested_) {
+    return;
+  }
+  // a burst of hot-plug notifications collapses into one refresh
+  const bool refresh = std::exchange(refresh_requested_, false);
+  const auto switch_to = std::exchange(switch_requested_, std::nullopt);
+  auto change = std::exchange(engine_change_requested_, std::nullopt);
+  if (switch_to) preferred_ = *switch_to;
+  const auto preferred = preferred_;
+  lock.unlock();
+
+  if (refresh && !headless_) Enumerate();
+  if (change) {
+    // reopens the same device, now at the engine's new format
+    const auto reopen = device_name_.empty() ? preferred : device_name_;
+    ApplyEngineChange(std::move(*change));
+    if (!switch_to) OpenDevice(reopen);
+  }
+  if (switch_to) {
+    OpenDevice(preferred);
+  } else if (!change) {
+    Reconcile(preferred);
+  }
+  lock.lock();
+}
+
+bool AudioDevices::Enumerate() {
+  ma_device_info* playback_device_infos;
+  ma_uint32 playback_device_count;
+  if (const auto result =
+          ma_context_get_devices(context_, &playback_device_infos,
+                                 &playback_device_count, nullptr, nullptr);
+      result != MA_SUCCESS) {
+    logging::MiniAudioError(result, "Failed to retrieve device list");
+    return false;
+  }
+
+  entries_.clear();
+  for (ma_uint32 i_device = 0; i_device < playback_device_count; ++i_device) {
+    entries_.push_back(
+        {playback_device_infos[i_device].name,
+         playback_device_infos[i_device].id});
+  }
+  PublishState();
+  return true;
+}
+
+bool AudioDevices::OpenDevice(const std::string& name) {
+  // what was playing before, closed by the first attempt
+  const auto previous = device_name_;
+  if (InitDevice(name)) return true;
+  if (!previous.empty() && previous != name) {
+    logging::Squad("Failed to open audio output '{}', reopening '{}'", name,
+                   previous);
+    if (InitDevice(previous)) return true;
+  }
+  if (name != kDefault && previous != kDefault) {
+    logging::Squad("Failed to open audio output '{}', falling back to '{}'",
+                   name, kDefault);
+    return InitDevice(kDefault);
+  }
+  return false;
+}
+
+bool AudioDevices::InitDevice(const std::string& name) {
+  if (IsOffline(name)) return OpenOffline(name);
+  if (headless_) return OpenOffline(kNoOutput);
+  const ma_device_id* device_id = nullptr;
+  if (name != kDefault) {
+    for (const auto& entry : entries_) {
+      if (entry.name == name) device_id = &entry.id;
+    }
+    if (!device_id) {
+      logging::Squad("Audio output device '{}' not found", name);
+    }
+  }
+
+  auto device_config = ma_device_config_init(ma_device_type_playback);
+  device_config.playback.pDeviceID = device_id;
+  device_config.playback.format = ma_format_f32;
+  // every device after the first is converted to the engine format by
+  // miniaudio
+  device_config.playback.channels = channels_;
+  device_config.sampleRate = sample_rate_;
+  device_config.dataCallback = DataCallback;
+  device_config.pUserData = this;
+
+  // two devices must never render the engine at the same time
+  CloseDevice();
+  device_ = std::make_unique<ma_device>();
+  if (const auto result =
+          ma_device_init(context_, &device_config, device_.get());
+      result != MA_SUCCESS) {
+    logging::MiniAudioError(result,
+                            std::format("Failed to open audio device {}", name));
+    device_.reset();
+    PublishState();
+    return false;
+  }
+  device_name_ = device_id ? name : kDefault;
+
+  if (engine_.load(std::memory_order_acquire)) {
+    const auto& playback = device_->playback;
+    if (playback.internalChannels != channels_ ||
+        playback.internalSampleRate != sample_rate_) {
+      logging::Debug(
+          "{} runs at {} channels {}Hz, the engine at {} channels {}Hz",
+          playback.name, playback.internalChannels,
+          playback.internalSampleRate, channels_, sample_rate_);
+      SetFormatChange(
+          Format{playback.internalChannels, playback.internalSampleRate});
+    } else {
+      SetFormatChange(std::nullopt);
+    }
+    if (const auto result = ma_device_start(device_.get());
+        result != MA_SUCCESS) {
+      logging::MiniAudioError(result, "Failed to start audio device");
+    }
+  }
+  logging::Debug("opened audio device {}", device_->playback.name);
+  PublishState();
+  return true;
+}
+
+bool AudioDevices::OpenOffline(const std::string& name) {
+  CloseDevice();
+  // the engine format is fixed once started, before then pick a common one
+  const auto channels = channels_ ? channels_ : 2;
+  const auto sample_rate = sample_rate_ ? sample_rate_ : 48000;
+  offline_ = std::make_unique<OfflineOutput>(
+      channels, sample_rate, [this](float* frames, const uint32_t frame_count) {
+        if (const auto engine = engine_.load(std::memory_order_acquire)) {
+          ma_engine_read_pcm_frames(engine, frames, frame_count, nullptr);
+        }
+        if (rendered_) rendered_(frames, frame_count);
+      });
+  if (name == kRecordOutput && !offline_->OpenFile(kRecordPath)) {
+    logging::Squad("Failed to create {}", kRecordPath);
+    offline_.reset();
+    PublishState();
+    return false;
+  }
+  offline_rendered_at_ = Clock::now();
+  device_name_ = name;
+  // renders at whatever the engine does
+  SetFormatChange(std::nullopt);
+  logging::Debug("opened offline output {}", name);
+  PublishState();
+  return true;
+}
+
+void AudioDevices::AdvanceOffline() {
+  const auto now = Clock::now();
+  // after a long stall, skip ahead rather than render it all at once
+  const auto elapsed = std::min<Clock::duration>(now - offline_rendered_at_,
+                                                 std::chrono::seconds(1));
+  offline_rendered_at_ = now;
+  if (engine_.load(std::memory_order_acquire)) offline_->Advance(elapsed);
+}
+
+void AudioDevices::CloseDevice() {
+  if (device_) {
+    ma_device_uninit(device_.get());
+    device_.reset();
+  }
+  // finishes the WAV file
+  offline_.reset();
+  device_name_.clear();
+}
+
+void AudioDevices::ApplyEngineChange(EngineChange change) {
+  // once closed nothing renders the previous engine
+  CloseDevice();
+  engine_.store(change.engine, std::memory_order_release);
+  channels_ = change.format.channels;
+  sample_rate_ = change.format.sample_rate;
+  change.previous.reset();
+  logging::Debug("audio now renders at {} channels {}Hz", channels_,
+                 sample_rate_);
+}
+
+void AudioDevices::SetFormatChange(const std::optional<Format> format) {
+  std::scoped_lock lock(mutex_);
+  changed_format_ = format;
+  format_changed_.store(format.has_value(), std::memory_order_release);
+}
+
+void AudioDevices::Reconcile(const std::string& preferred) {
+  const bool preferred_present =
+      preferred == kDefault || IsOffline(preferred) ||
+      std::ranges::any_of(entries_, [&](const Entry& entry) {
+        return entry.name == preferred;
+      });
+  if (preferred_present && device_name_ != preferred) {
+    OpenDevice(preferred);
+  } else if (!preferred_present &&
+             ((!device_ && !offline_) || device_name_ == preferred)) {
+    OpenDevice(kDefault);
+  }
+}
+
+void AudioDevices::PublishState() {
+  state_.PublishInPlace([this](State& state) {
+    state.names.clear();
+    state.names.emplace_back(kDefault);
+    state.names.emplace_back(kNoOutput);
+    state.names.emplace_back(kRecordOutput);
+    for (const auto& entry : entries_) state.names.push_back(entry.name);
+    if (offline_) {
+      state.current = device_name_;
+    } else {
+      state.current = device_ ? device_->playback.name : "None";
+    }
+  });
+  version_.fetch_add(1, std::memory_order_release);
+}
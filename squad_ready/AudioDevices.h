@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/OfflineOutput.h"
+#include "core/SnapshotPublisher.h"
+#include "miniaudio/extras/miniaudio_split/miniaudio.h"
+
+// Owns the playback device the engine renders into and a cached index of the
+// output devices. After startup all device work happens on its own thread,
+// woken by the options panel or by Windows reporting a device being added,
+// removed or made the default, so nothing enumerates or opens devices on the
+// render thread. The engine runs without a device of its own, so switching
+// devices keeps every loaded sound and just points a new device at it.
+//
+// Besides the real devices there are two offline outputs for machines without
+// a sound card, or to hear exactly what was mixed: kNoOutput renders and drops
+// the audio, kRecordOutput writes it to kRecordPath. Both render on the
+// device thread, paced by the wall clock.
+//
+// Headless, nothing opens a sound card and there is no device thread: only
+// the offline outputs play, and the owner renders them and runs the queued
+// work with Advance, on its own clock.
+class AudioDevices {
+ public:
+  static constexpr char kDefault[] = "Default";
+  static constexpr char kNoOutput[] = "No output";
+  static constexpr char kRecordOutput[] = "Record to WAV file";
+  static constexpr char kRecordPath[] =
+      "addons\\arcdps\\arcdps_squad_ready_output.wav";
+
+  struct Format {
+    ma_uint32 channels = 0;
+    ma_uint32 sample_rate = 0;
+  };
+
+  // Sees every block an offline output rendered, interleaved frames.
+  using Rendered =
+      std::function<void(const float* frames, uint32_t frame_count)>;
+
+  // What the options panel shows.
+  struct State {
+    // kDefault first, the offline outputs, then every output device
+    std::vector<std::string> names;
+    // name of the device playing right now, "None" if there isn't one
+    std::string current = "None";
+  };
+
+  AudioDevices() = default;
+  // Headless if given rendered, which may be empty.
+  explicit AudioDevices(std::optional<Rendered> rendered)
+      : headless_(rendered.has_value()),
+        rendered_(std::move(rendered).value_or(nullptr)) {}
+  AudioDevices(const AudioDevices&) = delete;
+  AudioDevices& operator=(const AudioDevices&) = delete;
+  ~AudioDevices() { Close(); }
+
+  // Enumerates the devices and opens the preferred one at its native format,
+  // falling back to the default. An offline output has no native format and
+  // uses stereo 48kHz. Blocking, called once before Start.
+  bool Open(ma_context* context, const std::string& preferred);
+  // Format the engine must render in, fixed by the device Open picked.
+  ma_uint32 Channels() const { return channels_; }
+  ma_uint32 SampleRate() const { return sample_rate_; }
+  // Starts rendering engine and, unless headless, the device thread.
+  bool Start(ma_engine* engine);
+  // Stops the device thread and closes the device, blocking.
+  void Close();
+
+  // Both queue work for the device thread and return immediately.
+  void Switch(const std::string& name);
+  void Refresh();
+  // The format of the device the device thread switched to, if it isn't the
+  // engine's, so every sound would be converted once more on the way out.
+  // Returns it once, the owner builds an engine at that format and hands it
+  // over with ChangeEngine. Cheap enough to call every frame.
+  std::optional<Format> TakeFormatChange();
+  // Queues moving the device over to engine, rendering at format. previous
+  // is released on the device thread once nothing renders the old engine, so
+  // the owner can hand over whatever the old engine needs to outlive.
+  void ChangeEngine(ma_engine* engine, Format format,
+                    std::shared_ptr<void> previous);
+  // Headless only. Does the queued work, then renders duration into the
+  // offline output.
+  void Advance(std::chrono::nanoseconds duration);
+
+  SnapshotPublisher<State>::Reader Get() const { return state_.Read(); }
+  // Any thread. Changes whenever a new State is published.
+  uint64_t Version() const { return version_.load(std::memory_order_acquire); }
+
+ private:
+  struct Entry {
+    std::string name;
+    ma_device_id id;
+  };
+  struct EngineChange {
+    ma_engine* engine;
+    Format format;
+    std::shared_ptr<void> previous;
+  };
+
+  using Clock = std::chrono::steady_clock;
+
+  // How often an offline output is rendered.
+  static constexpr std::chrono::milliseconds kOfflinePeriod{10};
+
+  static void DataCallback(ma_device* device, void* output, const void* input,
+                           ma_uint32 frame_count);
+  static bool IsOffline(const std::string& name) {
+    return name == kNoOutput || name == kRecordOutput;
+  }
+
+  void Run();
+  // Takes the queued requests and carries them out. Called with lock held,
+  // which it releases while opening devices.
+  void Service(std::unique_lock<std::mutex>& lock);
+  bool Enumerate();
+  // Replaces the open device with the named one, kDefault follows the system
+  // default device. If it fails to open, reopens the previous device or else
+  // the default, so a bad device never leaves nothing playing. False if none
+  // of them opened.
+  bool OpenDevice(const std::string& name);
+  // A single attempt at OpenDevice, without falling back.
+  bool InitDevice(const std::string& name);
+  bool OpenOffline(const std::string& name);
+  // Renders the wall clock time since the last call into the offline output.
+  void AdvanceOffline();
+  void CloseDevice();
+  // Closes the device and points it at the new engine, the caller reopens.
+  void ApplyEngineChange(EngineChange change);
+  // Records whether the device just opened runs at a format other than the
+  // engine's, see TakeFormatChange.
+  void SetFormatChange(std::optional<Format> format);
+  // Moves to the preferred device when it appears, and off it to the default
+  // when it goes away.
+  void Reconcile(const std::string& preferred);
+  void PublishState();
+
+  bool headless_ = false;
+  Rendered rendered_;
+  ma_context* context_ = nullptr;
+  std::atomic<ma_engine*> engine_ = nullptr;
+  std::unique_ptr<ma_device> device_;
+  // set instead of device_ while an offline output is in use
+  std::unique_ptr<OfflineOutput> offline_;
+  Clock::time_point offline_rendered_at_;
+  // what device_ or offline_ was opened as, kDefault or a device name
+  std::string device_name_;
+  ma_uint32 channels_ = 0;
+  ma_uint32 sample_rate_ = 0;
+  // mirrors changed_format_ having a value, so polling it takes no lock
+  std::atomic<bool> format_changed_ = false;
+  // device thread only once started
+  std::vector<Entry> entries_;
+  SnapshotPublisher<State> state_;
+  std::atomic<uint64_t> version_ = 0;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  // guarded by mutex_
+  std::string preferred_ = kDefault;
+  bool refresh_requested_ = false;
+  std::optional<std::string> switch_requested_;
+  std::optional<EngineChange> engine_change_requested_;
+  std::optional<Format> changed_format_;
+  bool stop_requested_ = false;
+};
@@ -0,0 +1,52 @@
+#include "AudioSettings.h"
+
+#include <utility>
+
+SoundBindings ResolveSoundBindings(const Settings::SettingsObject& settings) {
+  const auto gain = [](const int volume) { return volume / 100.0f; };
+  SoundBindings bindings;
+  const auto bind = [&](const SoundEvent event, std::string key,
+                        const int volume) {
+    bindings[static_cast<size_t>(event)] = {std::move(key), gain(volume)};
+  };
+  bind(SoundEvent::ReadyCheckStarted,
+       settings.ready_check_path.value_or(kBundledReadyCheck),
+       settings.ready_check_volume);
+  bind(SoundEvent::SquadReady,
+       settings.squad_ready_path.value_or(kBundledSquadReady),
+       settings.squad_ready_volume);
+  // the nag repeats the ready check sound unless given its own
+  bindings[static_cast<size_t>(SoundEvent::ReadyCheckNag)] =
+      bindings[static_cast<size_t>(SoundEvent::ReadyCheckStarted)];
+
+  for (size_t i = 0; i < kSoundEvents; i++) {
+    const auto event = static_cast<SoundEvent>(i);
+    const auto found = settings.event_sounds.find(SoundEventId(event));
+    if (found == settings.event_sounds.end() || !found->second.enabled) {
+      continue;
+    }
+    const auto& sound = found->second;
+    switch (event) {
+      case SoundEvent::ReadyCheckNag:
+        bind(event, sound.path.value_or(kBundledReadyCheck), sound.volume);
+        break;
+      case SoundEvent::SubgroupReady:
+        bind(event, sound.path.value_or(kBundledSquadReady), sound.volume);
+        break;
+      case SoundEvent::ReadyCheckCancelled:
+      case SoundEvent::MemberJoined:
+        // nothing bundled to fall back on
+        bind(event, sound.path.value_or(""), sound.volume);
+        break;
+      default:
+        // ready check and squad ready have their own settings
+        break;
+    }
+  }
+  return bindings;
+}
+
+AudioConfig ResolveAudioConfig(const Settings::SettingsObject& settings) {
+  return {ResolveSoundBindings(settings), settings.audio_output_device,
+          settings.normalize_volume};
+}
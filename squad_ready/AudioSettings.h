@@ -0,0 +1,9 @@
+#pragma once
+
+#include "Audio.h"
+#include "Settings.h"
+
+// What every event plays with these settings.
+SoundBindings ResolveSoundBindings(const Settings::SettingsObject& settings);
+// Everything the audio player takes from the settings.
+AudioConfig ResolveAudioConfig(const Settings::SettingsObject& settings);
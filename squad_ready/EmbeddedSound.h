@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// A bundled sound compiled into the DLL as interleaved f32 PCM, see
+// tools/embed_sounds.py.
+struct EmbeddedSound {
+  const float* samples;
+  uint64_t frame_count;
+  uint32_t channels;
+  uint32_t sample_rate;
+};
@@ -10,6 +10,8 @@ HMODULE self_dll;
 HWND some_window = nullptr;
 bool unofficial_extras_loaded;
 
+Metrics metrics;
+
 // updates
 std::unique_ptr<UpdateCheckerBase::UpdateState> update_state = nullptr;
 
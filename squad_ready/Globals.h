@@ -4,6 +4,7 @@
 
 #include <string>
 
+#include "core/Metrics.h"
 #include "extension/UpdateChecker.h"
 #include "extension/UpdateCheckerBase.h"
 
@@ -14,6 +15,9 @@ extern HMODULE self_dll;
 extern HWND some_window;
 extern bool unofficial_extras_loaded;
 
+// per frame costs, shown in the debug window
+extern Metrics metrics;
+
 // Updating myself stuff
 extern std::unique_ptr<UpdateCheckerBase::UpdateState> update_state;
 
@@ -1,57 +1,150 @@
 #include "Logging.h"
 
+#include <cstdio>
+#include <thread>
+
+#ifdef _WIN32
+#include "extension/arcdps_structs.h"
+#endif
+
+namespace logging {
+namespace {
+
+#if _DEBUG
+constexpr bool kDebugBuild = true;
+#else
+constexpr bool kDebugBuild = false;
+#endif
+
+detail::Queue queue;
+std::thread writer;
+std::atomic<bool> running = false;
+std::atomic<bool> stopping = false;
+// set by the writer thread while it waits for messages
+std::atomic<bool> sleeping = false;
+std::atomic<uint64_t> dropped = 0;
+
+void Output(const std::string& line) {
+#if _DEBUG
+  Arc(line.c_str());
+#endif
+  File(line.c_str());
+}
+
+void ReportDropped() {
+  if (const auto count = dropped.exchange(0, std::memory_order_relaxed)) {
+    Output(std::format("squad_ready: log queue was full, dropped {} messages",
+                       count));
+  }
+}
+
+void Drain() {
+  while (const auto record = queue.Front()) {
+    detail::Write(*record);
+    queue.Pop();
+  }
+  ReportDropped();
+}
+
+void WriterLoop() {
+  while (true) {
+    Drain();
+    sleeping.store(true, std::memory_order_relaxed);
+    // pairs with the fence in Wake, either the producer sees sleeping or this
+    // sees its message
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (stopping.load(std::memory_order_relaxed)) break;
+    if (queue.Empty()) sleeping.wait(true, std::memory_order_relaxed);
+    sleeping.store(false, std::memory_order_relaxed);
+  }
+  Drain();
+}
+
+}  // namespace
+}  // namespace logging
+
+std::atomic<logging::Level> logging::detail::level =
+    kDebugBuild ? Level::Debug : Level::Info;
+
+// Outside of arcdps, like a headless test run, both go to stderr.
 void logging::File(const char* str) {
+#ifdef _WIN32
   if (ARC_LOG_FILE) ARC_LOG_FILE(str);
+#else
+  std::fprintf(stderr, "%s\n", str);
+#endif
 }
 
 /* log to extensions tab in arcdps log window, thread/async safe */
 void logging::Arc(const char* str) {
+#ifdef _WIN32
   if (ARC_LOG) ARC_LOG(str);
+#else
+  File(str);
+#endif
 }
 
-void logging::Squad(char* str) {
-#if _DEBUG
-  Arc(std::format("squad_ready: {}", str).c_str());
-#endif
-  File(std::format("squad_ready: {}", str).c_str());
+void logging::SetDebugEnabled(const bool enabled) {
+  detail::level.store(enabled || kDebugBuild ? Level::Debug : Level::Info,
+                      std::memory_order_relaxed);
 }
 
-void logging::Squad(const char* str) {
-  Squad(const_cast<char*>(str));
+void logging::Start() {
+  if (running.load(std::memory_order_relaxed)) return;
+  stopping.store(false, std::memory_order_relaxed);
+  writer = std::thread(WriterLoop);
+  running.store(true, std::memory_order_release);
 }
 
-void logging::Squad(std::string str) {
-  Squad(const_cast<char*>(str.c_str()));
+void logging::Stop() {
+  if (!running.exchange(false, std::memory_order_acq_rel)) return;
+  stopping.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  sleeping.store(false, std::memory_order_relaxed);
+  sleeping.notify_one();
+  writer.join();
+  // anything pushed while stopping
+  Drain();
 }
 
-void logging::MiniAudioError(ma_result result, char* str) {
-  if (result != MA_SUCCESS) {
-    Squad(std::format("MiniAudio error: {} ({})", str, ma_result_description(result)).c_str());
+bool logging::detail::Running() {
+  return running.load(std::memory_order_acquire);
+}
+
+logging::detail::Queue& logging::detail::GetQueue() { return queue; }
+
+void logging::detail::Wake() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping.load(std::memory_order_relaxed)) {
+    sleeping.store(false, std::memory_order_relaxed);
+    sleeping.notify_one();
   }
 }
 
-void logging::MiniAudioError(ma_result result, const char* str) {
-  MiniAudioError(result, const_cast<char*>(str));
+void logging::detail::CountDropped() {
+  dropped.fetch_add(1, std::memory_order_relaxed);
 }
 
-void logging::MiniAudioError(ma_result result, std::string str) {
-  MiniAudioError(result, const_cast<char*>(str.c_str()));
+void logging::detail::Write(const Record& record) {
+  std::string line = record.level == Level::Debug ? "squad_ready: DEBUG: "
+                                                  : "squad_ready: ";
+  record.format_args(line, {record.format, record.format_size}, record.args);
+  if (record.truncated) line.append(" [truncated]");
+  Output(line);
 }
 
-void logging::Debug(char* str) {
-#if _DEBUG
-  Squad(std::format("DEBUG: {}", str).c_str());
-#endif
+void logging::Squad(const std::string_view str) {
+  detail::Log(Level::Info, "{}", str);
 }
 
-void logging::Debug(const char* str) {
-#if _DEBUG
-  Debug(const_cast<char*>(str));
-#endif
+void logging::MiniAudioError(const ma_result result,
+                             const std::string_view str) {
+  if (result != MA_SUCCESS) {
+    detail::Log(Level::Error, "MiniAudio error: {} ({})", str,
+                ma_result_description(result));
+  }
 }
 
-void logging::Debug(const std::string& str) {
-#if _DEBUG
-  Debug(const_cast<char*>(str.c_str()));
-#endif
+void logging::Debug(const std::string_view str) {
+  detail::Log(Level::Debug, "{}", str);
 }
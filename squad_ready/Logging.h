@@ -1,26 +1,131 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <format>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <tuple>
 
-#include "extension/arcdps_structs.h"
+#include "core/LogArgs.h"
+#include "core/MpscQueue.h"
 #include "miniaudio/extras/miniaudio_split/miniaudio.h"
 
+// Messages are queued as a format string and their arguments in binary, and
+// formatted and written to arcdps by a background thread, so logging from
+// the extras callback or the audio code costs a copy of the arguments.
+// Messages below the current level cost a single atomic load.
 namespace logging {
 /* log to arcdps.log, thread/async safe */
 void File(const char* str);
 /* log to extensions tab in arcdps log window, thread/async safe */
 void Arc(const char* str);
 
-void Squad(char* str);
-void Squad(const char* str);
-void Squad(std::string str);
+enum class Level : uint8_t {
+  Debug,
+  Info,
+  Error,
+};
 
-void MiniAudioError(ma_result result, char* str);
-void MiniAudioError(ma_result result, const char* str);
-void MiniAudioError(ma_result result, std::string str);
+// Any thread.
+inline bool Enabled(Level level);
+// Debug messages are always written in debug builds, and in release builds
+// only while enabled here.
+void SetDebugEnabled(bool enabled);
 
-void Debug(char* str);
-void Debug(const char* str);
-void Debug(const std::string& str);
+// Starts the thread writing queued messages. Until then, and after Stop,
+// messages are written on the calling thread.
+void Start();
+// Writes what is still queued and stops the thread.
+void Stop();
+
+namespace detail {
+
+struct Record {
+  using FormatArgs = void (*)(std::string& out, std::string_view format,
+                              const std::byte* args);
+
+  // the format string literal of the call site, together with format_args
+  // it identifies the message
+  const char* format;
+  FormatArgs format_args;
+  uint16_t format_size;
+  Level level;
+  bool truncated;
+  // fills the rest of a 256 byte queue slot
+  std::byte args[228];
+};
+
+using Queue = MpscQueue<Record, 256>;
+
+extern std::atomic<Level> level;
+
+bool Running();
+Queue& GetQueue();
+// Wakes the writer thread after a push.
+void Wake();
+void CountDropped();
+// Formats and writes record on the calling thread.
+void Write(const Record& record);
+
+template <typename... Args>
+void FormatArgs(std::string& out, const std::string_view format,
+                const std::byte* args) {
+  auto values = log_args::Decode<Args...>(args);
+  std::apply(
+      [&](auto&... value) {
+        std::vformat_to(std::back_inserter(out), format,
+                        std::make_format_args(value...));
+      },
+      values);
+}
+
+template <typename... Args>
+void Log(const Level level, const std::string_view format,
+         const Args&... args) {
+  if (!Enabled(level)) return;
+  const auto fill = [&](Record& record) {
+    record.format = format.data();
+    record.format_args = &FormatArgs<Args...>;
+    record.format_size = static_cast<uint16_t>(format.size());
+    record.level = level;
+    log_args::Encode(record.args, sizeof(record.args), record.truncated,
+                     args...);
+  };
+  if (!Running()) {
+    Record record;
+    fill(record);
+    Write(record);
+    return;
+  }
+  if (!GetQueue().TryPushWith(fill)) {
+    CountDropped();
+    return;
+  }
+  Wake();
+}
+
+}  // namespace detail
+
+inline bool Enabled(const Level level) {
+  return level >= detail::level.load(std::memory_order_relaxed);
+}
+
+// Formatted later on the writer thread. Arguments can be numbers, pointers
+// and strings, strings are copied and may be cut short.
+template <typename... Args>
+void Squad(std::format_string<const Args&...> format, const Args&... args) {
+  detail::Log(Level::Info, format.get(), args...);
+}
+void Squad(std::string_view str);
+
+void MiniAudioError(ma_result result, std::string_view str);
+
+template <typename... Args>
+void Debug(std::format_string<const Args&...> format, const Args&... args) {
+  detail::Log(Level::Debug, format.get(), args...);
+}
+void Debug(std::string_view str);
 }  // namespace logging
@@ -1,38 +1,62 @@
 #include "Settings.h"
 
+#include <filesystem>
 #include <fstream>
 
 #include "Logging.h"
+#include "core/ReadyCheckTracker.h"
 
 void Settings::load() {
   // according to standard, this constructor is completely thread-safe
   // read settings from file
   ReadFromFile();
+  Publish();
+}
+
+void Settings::Publish() {
+  snapshots_.Publish(settings_);
+  version_.fetch_add(1, std::memory_order_release);
 }
 
 void Settings::unload() {
+  // writes a change still waiting out kSaveDelay
+  saver_.Stop();
+}
+
+// On the saver thread, from the published snapshot rather than settings_,
+// which the UI thread may be changing.
+void Settings::SaveToFile() {
   try {
-    SaveToFile();
+    const auto contents = nlohmann::json(*snapshots_.Read()).dump();
+
+    // written whole to a temporary file and renamed over the old one, so a
+    // crash never leaves a half-written file
+    const std::filesystem::path path = kSettingsJsonPath;
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+    std::error_code error;
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    // closing flushes, which is where a full disk shows up
+    file.close();
+    if (file.fail()) {
+      std::filesystem::remove(temporary_path, error);
+      logging::Squad("Failed to save settings to {}", temporary_path.string());
+      return;
+    }
+    std::filesystem::rename(temporary_path, path, error);
+    if (error) {
+      logging::Squad("Failed to save settings: {}", error.message());
+      std::filesystem::remove(temporary_path, error);
+      return;
+    }
+    logging::Debug("saved settings");
   } catch (const std::exception& e) {
     logging::Squad("Failed to save settings");
     logging::Squad(e.what());
   }
 }
 
-void Settings::SaveToFile() {
-  // create json object
-  const auto json = nlohmann::json(settings);
-
-  // open output file
-  std::ofstream json_file(kSettingsJsonPath);
-
-  // save json to file
-  json_file << json;
-
-  // close file
-  json_file.close();
-}
-
 void Settings::ReadFromFile() {
   try {
     // read a JSON file as stream
@@ -46,11 +70,16 @@ void Settings::ReadFromFile() {
       json_file.close();
 
       // get the object into the settings object
-      json.get_to(settings);
+      json.get_to(settings_);
 
       /**
        * MIGRATIONS
        */
+
+      // hand edited files can hold anything, an interval of zero would nag
+      // every frame
+      settings_.ready_check_nag_interval_seconds =
+          ClampNagInterval(settings_.ready_check_nag_interval_seconds);
     }
   } catch (const std::exception& e) {
     logging::Squad(
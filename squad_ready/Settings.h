@@ -1,7 +1,14 @@
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <map>
 #include <nlohmann/json.hpp>
+#include <utility>
+#include <vector>
 
+#include "core/DebouncedSaver.h"
+#include "core/SnapshotPublisher.h"
 #include "extension/Singleton.h"
 #include "extension/arcdps_structs.h"
 #include "extension/nlohmannJsonExtension.h"
@@ -12,6 +19,20 @@ const std::string kSettingsJsonPath = "addons\\arcdps\\arcdps_squad_ready.json";
 
 class Settings final : public Singleton<Settings, false> {
  public:
+  // Sound for one of the events past ready check and squad ready, keyed by
+  // SoundEventId in SettingsObject::event_sounds.
+  struct EventSound {
+    bool enabled = false;
+    // the event's bundled default if unset, if it has one
+    std::optional<std::string> path;
+    int volume = 100;
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_NON_THROWING(EventSound, enabled, path,
+                                                volume)
+
+    bool operator==(const EventSound& other) const = default;
+  };
+
   struct SettingsObject {
     uint32_t version = 1;
     std::optional<std::string> ready_check_path;
@@ -23,6 +44,12 @@ class Settings final : public Singleton<Settings, false> {
     bool ready_check_nag_in_combat = false;
     float ready_check_nag_interval_seconds = 5.0f;
     std::optional<std::string> audio_output_device;
+    // transparent, so looking up a SoundEventId doesn't build a string
+    std::map<std::string, EventSound, std::less<>> event_sounds;
+    // evens out the loudness of the sounds on top of their volumes
+    bool normalize_volume = true;
+    // debug messages in arcdps.log, always on in debug builds
+    bool debug_logging = false;
 
     NLOHMANN_DEFINE_TYPE_INTRUSIVE_NON_THROWING(SettingsObject,
                                                 ready_check_path,
@@ -33,15 +60,49 @@ class Settings final : public Singleton<Settings, false> {
                                                 ready_check_nag,
                                                 ready_check_nag_in_combat,
                                                 ready_check_nag_interval_seconds,
-                                                audio_output_device)
+                                                audio_output_device,
+                                                event_sounds,
+                                                normalize_volume,
+                                                debug_logging)
+
+    bool operator==(const SettingsObject& other) const = default;
   };
 
+  using Snapshot = SnapshotPublisher<SettingsObject>::Reader;
+  using Subscriber = std::function<void(const SettingsObject& previous,
+                                        const SettingsObject& current)>;
+
   Settings() = default;
 
   void load();
   void unload();
 
-  SettingsObject settings;
+  // Any thread. Changes whenever a new version is published, so hot paths can
+  // check for changes with a single atomic load.
+  uint64_t Version() const { return version_.load(std::memory_order_acquire); }
+  // Any thread. The current version, immutable and never blocking.
+  Snapshot Get() const { return snapshots_.Read(); }
+
+  // UI thread only. Applies f to a copy of the current settings and, if that
+  // changed anything, publishes it, notifies the subscribers and schedules a
+  // save.
+  template <typename F>
+  void Update(F&& f) {
+    SettingsObject next = settings_;
+    f(next);
+    if (next == settings_) return;
+    const SettingsObject previous = std::exchange(settings_, std::move(next));
+    Publish();
+    for (const auto& subscriber : subscribers_) {
+      subscriber(previous, settings_);
+    }
+    saver_.Changed();
+  }
+
+  // UI thread only. Called after every published change.
+  void Subscribe(Subscriber subscriber) {
+    subscribers_.push_back(std::move(subscriber));
+  }
 
   // delete copy/move
   Settings(const Settings& other) = delete;
@@ -50,6 +111,18 @@ class Settings final : public Singleton<Settings, false> {
   Settings& operator=(Settings&& other) noexcept = delete;
 
  private:
+  // quiet time after the last change before it is saved
+  static constexpr std::chrono::seconds kSaveDelay{1};
+
+  void Publish();
   void SaveToFile();
   void ReadFromFile();
+
+  // writer's copy of the latest version
+  SettingsObject settings_;
+  SnapshotPublisher<SettingsObject> snapshots_;
+  std::atomic<uint64_t> version_{0};
+  std::vector<Subscriber> subscribers_;
+  // saves the latest snapshot in the background, stopped first on destruction
+  DebouncedSaver saver_{kSaveDelay, [this] { SaveToFile(); }};
 };
@@ -1,175 +1,251 @@
 #include "SettingsUI.h"
 
+#include <bit>
+#include <optional>
 #include <string>
 
 #include "Audio.h"
 #include "Globals.h"
+#include "Logging.h"
 #include "Settings.h"
+#include "Startup.h"
+#include "core/AllocationCounter.h"
+#include "core/ReadyCheckTracker.h"
 #include "extension/imgui_stdlib.h"
 #include "imgui/imgui.h"
 #include "ImGuiFileDialog/ImGuiFileDialog.h"
 
-void DrawReadyCheck() {
-  Settings::instance([](Settings& settings) {
-    ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "Ready Check");
+// ImGuiFileDialog takes its keys as strings, built once rather than every
+// frame
+const std::string kReadyCheckDialogKey = "ChooseReadyCheckFileDlgKey";
+const std::string kSquadReadyDialogKey = "ChooseSquadReadyFileDlgKey";
 
-    // Volume
-    int& ready_check_volume = settings.settings.ready_check_volume;
-    if (ImGui::SliderInt("Volume - Ready Check", &ready_check_volume, 0, 100,
-                         "%d%%")) {
-      AudioPlayer::instance([&](AudioPlayer& audio_player) {
-        audio_player.UpdateReadyCheckVolume(ready_check_volume);
-      });
-    }
+// Text field for a sound path, see PathEdit.
+bool InputPath(const char* label, PathEdit& edit,
+               const std::optional<std::string>& path) {
+  edit.Sync(path);
+  ImGui::InputText(label, &edit.buffer);
+  edit.active = ImGui::IsItemActive();
+  return ImGui::IsItemDeactivatedAfterEdit();
+}
 
-    // Path
-    std::string ready_check_path =
-        settings.settings.ready_check_path.value_or("");
-    if (ImGui::InputText(
-            "Path to file to play on ready check (blank for default)",
-            &ready_check_path)) {
-      if (ready_check_path.empty()) {
-        settings.settings.ready_check_path.reset();
-      } else {
-        settings.settings.ready_check_path = ready_check_path;
-      }
-      if (ImGui::IsItemDeactivatedAfterEdit()) {
-        AudioPlayer::instance([&](AudioPlayer& audio_player) {
-          audio_player.UpdateReadyCheck(
-              settings.settings.ready_check_path.value_or(""));
-        });
-      }
-    }
+std::optional<std::string> OptionalPath(const std::string& path) {
+  if (path.empty()) return std::nullopt;
+  return path;
+}
 
-    // Path - Dialog
-    if (ImGui::Button("Open Ready Check File")) {
-      ImGuiFileDialog::Instance()->OpenDialog(
-          "ChooseReadyCheckFileDlgKey", "Choose Ready Check File", ".*",
-          settings.settings.ready_check_path.value_or("."), 1, nullptr,
-          ImGuiFileDialogFlags_Modal);
-    }
-    if (ImGuiFileDialog::Instance()->Display("ChooseReadyCheckFileDlgKey", 0,
-                                             ImVec2(400, 200))) {
-      if (ImGuiFileDialog::Instance()->IsOk()) {
-        settings.settings.ready_check_path =
-            ImGuiFileDialog::Instance()->GetFilePathName();
-      }
-      AudioPlayer::instance([&](AudioPlayer& audio_player) {
-        audio_player.UpdateReadyCheck(
-            settings.settings.ready_check_path.value_or(""));
-      });
-      ImGuiFileDialog::Instance()->Close();
-    }
+// Play button, reloads the sound first so a fixed file is picked up.
+void PlayButton(const char* label, const SoundEvent event) {
+  if (ImGui::Button(label)) {
+    AudioPlayer::instance([&](AudioPlayer& audio_player) {
+      if (audio_player.ReloadSound(event)) audio_player.Play(event);
+    });
+  }
+}
 
-    // Play button for testing
+// Why the sound failed to load, or how it is held in memory and how its
+// levels were adjusted.
+void DrawSoundStatus(const OptionsView::Sound& sound) {
+  if (!sound.error.empty()) {
     ImGui::SameLine();
-    if (ImGui::Button("Play Ready Check")) {
-      AudioPlayer::instance([&](AudioPlayer& audio_player) {
-        if (audio_player.UpdateReadyCheck(
-                settings.settings.ready_check_path.value_or(""))) {
-          audio_player.PlayReadyCheck();
-        }
+    ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s",
+                       sound.error.c_str());
+  } else if (!sound.details.empty()) {
+    ImGui::SameLine();
+    ImGui::TextDisabled("%s", sound.details.c_str());
+  }
+}
+
+void DrawReadyCheck(PathEdit& path_edit,
+                    const OptionsView& view) {
+  auto& settings = Settings::instance();
+  const auto current = settings.Get();
+  ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "Ready Check");
+
+  // Volume
+  int ready_check_volume = current->ready_check_volume;
+  if (ImGui::SliderInt("Volume - Ready Check", &ready_check_volume, 0, 100,
+                       "%d%%")) {
+    settings.Update([&](Settings::SettingsObject& s) {
+      s.ready_check_volume = ready_check_volume;
+    });
+  }
+
+  // Path
+  if (InputPath("Path to file to play on ready check (blank for default)",
+                path_edit, current->ready_check_path)) {
+    settings.Update([&](Settings::SettingsObject& s) {
+      s.ready_check_path = OptionalPath(path_edit.buffer);
+    });
+  }
+
+  // Path - Dialog
+  if (ImGui::Button("Open Ready Check File")) {
+    ImGuiFileDialog::Instance()->OpenDialog(
+        kReadyCheckDialogKey, "Choose Ready Check File", ".*",
+        current->ready_check_path.value_or("."), 1, nullptr,
+        ImGuiFileDialogFlags_Modal);
+  }
+  if (ImGuiFileDialog::Instance()->Display(kReadyCheckDialogKey, 0,
+                                           ImVec2(400, 200))) {
+    if (ImGuiFileDialog::Instance()->IsOk()) {
+      settings.Update([](Settings::SettingsObject& s) {
+        s.ready_check_path = ImGuiFileDialog::Instance()->GetFilePathName();
       });
     }
+    ImGuiFileDialog::Instance()->Close();
+  }
 
-    // Status of file
-    AudioPlayer::instance([&](AudioPlayer& audio_player) {
-      const auto ready_check_status =
-          audio_player.ReadyCheckStatus();
-      if (!ready_check_status.empty()) {
-        ImGui::SameLine();
-        ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f),
-                           ready_check_status.c_str());
-      }
-    });
+  // Play button for testing
+  ImGui::SameLine();
+  PlayButton("Play Ready Check", SoundEvent::ReadyCheckStarted);
 
-    // Nag options
-    bool& nag = settings.settings.ready_check_nag;
-    // bool& nag_in_combat = settings.settings.ready_check_nag_in_combat;
-    float& nag_interval = settings.settings.ready_check_nag_interval_seconds;
-    ImGui::Checkbox("Nag if not readied", &nag);
-    // ImGui::Checkbox("Nag in combat", &nag_in_combat);
-    ImGui::InputFloat("Nag interval in seconds", &nag_interval, 0.1f, 0,
-                      "%.1f");
-  });
+  // Status of file
+  DrawSoundStatus(view.Of(SoundEvent::ReadyCheckStarted));
+
+  // Nag options
+  bool nag = current->ready_check_nag;
+  float nag_interval = current->ready_check_nag_interval_seconds;
+  if (ImGui::Checkbox("Nag if not readied", &nag)) {
+    settings.Update(
+        [&](Settings::SettingsObject& s) { s.ready_check_nag = nag; });
+  }
+  if (ImGui::InputFloat("Nag interval in seconds", &nag_interval, 0.1f, 0,
+                        "%.1f")) {
+    settings.Update([&](Settings::SettingsObject& s) {
+      s.ready_check_nag_interval_seconds = ClampNagInterval(nag_interval);
+    });
+  }
 }
 
-void DrawSquadReady() {
-  Settings::instance([](Settings& settings) {
-    ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "Squad Ready");
+void DrawSquadReady(PathEdit& path_edit,
+                    const OptionsView& view) {
+  auto& settings = Settings::instance();
+  const auto current = settings.Get();
+  ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "Squad Ready");
 
-    int& squad_ready_volume = settings.settings.squad_ready_volume;
-    if (ImGui::SliderInt("Volume - Squad Ready", &squad_ready_volume, 0, 100,
-                         "%d%%")) {
-      AudioPlayer::instance([&](AudioPlayer& audio_player) {
-        audio_player.UpdateSquadReadyVolume(squad_ready_volume);
+  int squad_ready_volume = current->squad_ready_volume;
+  if (ImGui::SliderInt("Volume - Squad Ready", &squad_ready_volume, 0, 100,
+                       "%d%%")) {
+    settings.Update([&](Settings::SettingsObject& s) {
+      s.squad_ready_volume = squad_ready_volume;
+    });
+  }
+
+  if (InputPath("Path to file to play on squad ready (blank for default)",
+                path_edit, current->squad_ready_path)) {
+    settings.Update([&](Settings::SettingsObject& s) {
+      s.squad_ready_path = OptionalPath(path_edit.buffer);
+    });
+  }
+
+  if (ImGui::Button("Open Squad Ready File")) {
+    ImGuiFileDialog::Instance()->OpenDialog(
+        kSquadReadyDialogKey, "Choose Squad Ready File", ".*",
+        current->squad_ready_path.value_or("."), 1, nullptr,
+        ImGuiFileDialogFlags_Modal);
+  }
+  if (ImGuiFileDialog::Instance()->Display(kSquadReadyDialogKey, 0,
+                                           ImVec2(400, 200))) {
+    if (ImGuiFileDialog::Instance()->IsOk()) {
+      settings.Update([](Settings::SettingsObject& s) {
+        s.squad_ready_path = ImGuiFileDialog::Instance()->GetFilePathName();
       });
     }
+    ImGuiFileDialog::Instance()->Close();
+  }
+  ImGui::SameLine();
+  PlayButton("Play Squad Ready", SoundEvent::SquadReady);
+  DrawSoundStatus(view.Of(SoundEvent::SquadReady));
+}
 
-    std::string squad_ready_path =
-        settings.settings.squad_ready_path.value_or("");
-    if (ImGui::InputText(
-            "Path to file to play on squad ready (blank for default)",
-            &squad_ready_path)) {
-      if (squad_ready_path.empty()) {
-        settings.settings.squad_ready_path.reset();
-      } else {
-        settings.settings.squad_ready_path = squad_ready_path;
-      }
-      if (ImGui::IsItemDeactivatedAfterEdit()) {
-        AudioPlayer::instance([&](AudioPlayer& audio_player) {
-          audio_player.UpdateSquadReady(
-              settings.settings.squad_ready_path.value_or(""));
-        });
-      }
-    }
+// Optional sounds for the other events, all with the same controls.
+void DrawEventSound(const SoundEvent event, const char* enable_label,
+                    const char* default_description,
+                    PathEdit& path_edit,
+                    const OptionsView& view) {
+  static const Settings::EventSound kNotSet;
+  auto& settings = Settings::instance();
+  const auto current = settings.Get();
+  const char* id = SoundEventId(event);
+  const auto found = current->event_sounds.find(std::string_view(id));
+  const auto& sound =
+      found != current->event_sounds.end() ? found->second : kNotSet;
+  const auto update = [&](auto&& f) {
+    settings.Update(
+        [&](Settings::SettingsObject& s) { f(s.event_sounds[id]); });
+  };
 
-    if (ImGui::Button("Open Squad Ready File")) {
-      ImGuiFileDialog::Instance()->OpenDialog(
-          "ChooseSquadReadyFileDlgKey", "Choose Squad Ready File", ".*",
-          settings.settings.squad_ready_path.value_or("."), 1, nullptr,
-          ImGuiFileDialogFlags_Modal);
-    }
-    if (ImGuiFileDialog::Instance()->Display("ChooseSquadReadyFileDlgKey", 0,
-                                             ImVec2(400, 200))) {
-      if (ImGuiFileDialog::Instance()->IsOk()) {
-        settings.settings.squad_ready_path =
-            ImGuiFileDialog::Instance()->GetFilePathName();
-      }
-      AudioPlayer::instance([&](AudioPlayer& audio_player) {
-        audio_player.UpdateSquadReady(
-            settings.settings.squad_ready_path.value_or(""));
-      });
-      ImGuiFileDialog::Instance()->Close();
+  ImGui::PushID(id);
+  bool enabled = sound.enabled;
+  if (ImGui::Checkbox(enable_label, &enabled)) {
+    update([&](Settings::EventSound& s) { s.enabled = enabled; });
+  }
+  if (enabled) {
+    ImGui::Indent();
+    int volume = sound.volume;
+    if (ImGui::SliderInt("Volume", &volume, 0, 100, "%d%%")) {
+      update([&](Settings::EventSound& s) { s.volume = volume; });
     }
-    ImGui::SameLine();
-    if (ImGui::Button("Play Squad Ready")) {
-      AudioPlayer::instance([&](AudioPlayer& audio_player) {
-        if (audio_player.UpdateSquadReady(
-                settings.settings.squad_ready_path.value_or(""))) {
-          audio_player.PlaySquadReady();
-        }
+    if (InputPath(default_description, path_edit, sound.path)) {
+      update([&](Settings::EventSound& s) {
+        s.path = OptionalPath(path_edit.buffer);
       });
     }
-    AudioPlayer::instance([&](AudioPlayer& audio_player) {
-      const auto squad_ready_status = audio_player.SquadReadyStatus();
-      if (!squad_ready_status.empty()) {
-        ImGui::SameLine();
-        ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f),
-                           squad_ready_status.c_str());
-      }
-    });
-  });
+    PlayButton("Play", event);
+    DrawSoundStatus(view.Of(event));
+    ImGui::Unindent();
+  }
+  ImGui::PopID();
+}
+
+void DrawMoreSounds(std::array<PathEdit, kSoundEvents>& path_edits,
+                    const OptionsView& view) {
+  ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "More Sounds");
+  // the same file for several events is only loaded once
+  const auto draw = [&](const SoundEvent event, const char* enable_label,
+                        const char* default_description) {
+    DrawEventSound(event, enable_label, default_description,
+                   path_edits[static_cast<size_t>(event)], view);
+  };
+  draw(SoundEvent::ReadyCheckNag, "Different sound for the nag",
+       "Path to file (blank for the default ready check)");
+  draw(SoundEvent::ReadyCheckCancelled, "Play on ready check cancelled",
+       "Path to file");
+  draw(SoundEvent::SubgroupReady, "Play on subgroup ready",
+       "Path to file (blank for the default squad ready)");
+  draw(SoundEvent::MemberJoined, "Play on squad member joined",
+       "Path to file");
 }
 
 void DrawGlobalSettings() {
-  Settings::instance([](Settings& settings) {
-    bool& flash_window = settings.settings.flash_window;
-    ImGui::Checkbox("Flash window and tray icon", &flash_window);
-  });
+  auto& settings = Settings::instance();
+  bool flash_window = settings.Get()->flash_window;
+  if (ImGui::Checkbox("Flash window and tray icon", &flash_window)) {
+    settings.Update(
+        [&](Settings::SettingsObject& s) { s.flash_window = flash_window; });
+  }
+  bool normalize_volume = settings.Get()->normalize_volume;
+  if (ImGui::Checkbox("Even out the loudness of sounds", &normalize_volume)) {
+    settings.Update([&](Settings::SettingsObject& s) {
+      s.normalize_volume = normalize_volume;
+    });
+  }
+  if (ImGui::IsItemHovered()) {
+    ImGui::SetTooltip(
+        "Plays every sound at about the level of the default ones before "
+        "applying its volume. Silence at the start of a sound is always "
+        "skipped.");
+  }
+  bool debug_logging = settings.Get()->debug_logging;
+  if (ImGui::Checkbox("Write debug messages to arcdps.log", &debug_logging)) {
+    settings.Update(
+        [&](Settings::SettingsObject& s) { s.debug_logging = debug_logging; });
+  }
 }
 
-void DrawStatus(std::unique_ptr<SquadTracker>& tracker) {
+void DrawStatus(std::unique_ptr<SquadTracker>& tracker,
+                const OptionsView& view) {
   ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "Status");
 
   ImGui::BeginGroup();
@@ -186,53 +262,77 @@ void DrawStatus(std::unique_ptr<SquadTracker>& tracker) {
         "Unofficial extras is required for receiving squad member updates.");
   }
 
-  AudioPlayer::instance([](AudioPlayer& audio_player) {
-    Settings::instance([&](Settings& settings) {
-      std::vector<std::string> devices = audio_player.OutputDevices();
-      const auto preview_value =
-          settings.settings.audio_output_device.value_or("Default");
-
-      if (ImGui::BeginCombo("Output device", preview_value.c_str())) {
-        for (const auto& device : devices) {
-          const bool is_selected = (preview_value == device);
-          if (ImGui::Selectable(device.c_str(), is_selected)) {
-            if (preview_value != device) {
-              settings.settings.audio_output_device = device;
-              audio_player.UpdateOutputDevice(device);
-              audio_player.ReInit();
-            }
-          }
-          if (is_selected) {
-            ImGui::SetItemDefaultFocus();
-          }
-        }
-        ImGui::EndCombo();
+  if (tracker) {
+    const auto snapshot = tracker->Snapshot();
+    const auto& players = snapshot->players;
+    if (snapshot->in_ready_check) {
+      ImGui::Text("Ready check: %d/%d ready",
+                  std::popcount(players.EligibleMask() & players.ReadyMask()),
+                  std::popcount(players.EligibleMask()));
+    } else {
+      ImGui::Text("Squad members: %d", std::popcount(players.EligibleMask()));
+    }
+  }
+
+  // changing the device notifies the audio player, so don't hold it here
+  auto& settings = Settings::instance();
+  const auto& preview_value = view.selected_device;
+  if (ImGui::BeginCombo("Output device", preview_value.c_str())) {
+    for (const auto& device : view.devices) {
+      const bool is_selected = (preview_value == device);
+      if (ImGui::Selectable(device.c_str(), is_selected)) {
+        settings.Update([&](Settings::SettingsObject& s) {
+          s.audio_output_device = device;
+        });
       }
-      if (ImGui::Button("Refresh Audio Devices")) {
-        audio_player.UpdateOutputDevices();
+      if (is_selected) {
+        ImGui::SetItemDefaultFocus();
       }
-    });
+    }
+    ImGui::EndCombo();
+  }
 
-    ImGui::Text(std::format("Current output device: {}", audio_player.OutputDeviceName())
-                    .c_str());
-    if (ImGui::Button("Reset Audio")) {
+  if (ImGui::Button("Refresh Audio Devices")) {
+    AudioPlayer::instance(
+        [](AudioPlayer& audio_player) { audio_player.RefreshOutputDevices(); });
+  }
+  ImGui::Text("Current output device: %s", view.current_device.c_str());
+  if (ImGui::Button("Reset Audio")) {
+    AudioPlayer::instance([](AudioPlayer& audio_player) {
       audio_player.ReInit();
-    }
-  });
+    });
+  }
   if (ImGui::Button("Open Debug Window")) {
     tracker->MakeDebugWindowVisible();
   }
 }
 
 void SettingsUI::Draw(std::unique_ptr<SquadTracker>& tracker) {
+  const ScopedTimer timer(globals::metrics, Metric::OptionsPanel);
+  if (!startup::Ready()) {
+    ImGui::Separator();
+    ImGui::TextDisabled("Loading settings and audio...");
+    return;
+  }
+
+  const auto allocations = allocation_counter::ThisThread();
+  const bool rebuilt = UpdateView();
+
   ImGui::Separator();
   ImGui::Spacing();
-  DrawReadyCheck();
+  DrawReadyCheck(
+      sound_paths_[static_cast<size_t>(SoundEvent::ReadyCheckStarted)], view_);
 
   ImGui::Spacing();
   ImGui::Separator();
   ImGui::Spacing();
-  DrawSquadReady();
+  DrawSquadReady(sound_paths_[static_cast<size_t>(SoundEvent::SquadReady)],
+                 view_);
+
+  ImGui::Spacing();
+  ImGui::Separator();
+  ImGui::Spacing();
+  DrawMoreSounds(sound_paths_, view_);
 
   ImGui::Spacing();
   ImGui::Separator();
@@ -242,5 +342,37 @@ void SettingsUI::Draw(std::unique_ptr<SquadTracker>& tracker) {
   ImGui::Spacing();
   ImGui::Separator();
   ImGui::Spacing();
-  DrawStatus(tracker);
+  DrawStatus(tracker, view_);
+
+  // Debug builds check that a frame in which nothing changed and nothing was
+  // clicked or typed into didn't allocate. The file dialogs allocate on
+  // their own while open, so those frames don't count. Logged once until a
+  // frame passes again, rather than asserting in the middle of a game.
+  if (allocation_counter::kEnabled && !rebuilt && !ViewOutOfDate() &&
+      !ImGui::IsAnyItemActive() && !ImGui::IsMouseReleased(0) &&
+      !ImGuiFileDialog::Instance()->IsOpened()) {
+    const bool allocated = allocation_counter::ThisThread() != allocations;
+    if (allocated && !allocation_reported_) {
+      logging::Debug("the options panel allocated while nothing changed");
+    }
+    allocation_reported_ = allocated;
+  }
+}
+
+bool SettingsUI::ViewOutOfDate() const {
+  return view_.OutOfDate(Settings::instance().Version(),
+                         AudioPlayer::instance().Version());
+}
+
+bool SettingsUI::UpdateView() {
+  // versions first, so a change while building shows up next frame
+  const auto settings_version = Settings::instance().Version();
+  const auto audio_version = AudioPlayer::instance().Version();
+  if (!view_.OutOfDate(settings_version, audio_version)) return false;
+  AudioPlayer::instance([&](AudioPlayer& audio_player) {
+    view_.Rebuild(settings_version, audio_version,
+                  Settings::instance().Get()->audio_output_device,
+                  audio_player);
+  });
+  return true;
 }
@@ -1,10 +1,27 @@
 #pragma once
+#include <array>
+#include <string>
+#include <vector>
+
 #include "SquadTracker.h"
+#include "core/OptionsView.h"
+#include "core/SoundEvent.h"
 #include "extension/Singleton.h"
 
 class SettingsUI : public Singleton<SettingsUI, false> {
  public:
   SettingsUI() = default;
 
-  static void Draw(std::unique_ptr<SquadTracker>& tracker);
+  void Draw(std::unique_ptr<SquadTracker>& tracker);
+
+ private:
+  // Rebuilds view_ if it is out of date, true if it was.
+  bool UpdateView();
+  bool ViewOutOfDate() const;
+
+  // one per SoundEvent
+  std::array<PathEdit, kSoundEvents> sound_paths_;
+  OptionsView view_;
+  // debug builds, an idle frame allocated and was logged, see Draw
+  bool allocation_reported_ = false;
 };
@@ -1,92 +1,134 @@
 #include "SquadTracker.h"
 
+#include <array>
+#include <bit>
+
 #include "Globals.h"
 #include "Settings.h"
+#include "Startup.h"
+
+static_assert(static_cast<uint8_t>(SquadRole::SquadLeader) ==
+              static_cast<uint8_t>(UserRole::SquadLeader));
+static_assert(static_cast<uint8_t>(SquadRole::Lieutenant) ==
+              static_cast<uint8_t>(UserRole::Lieutenant));
+static_assert(static_cast<uint8_t>(SquadRole::Member) ==
+              static_cast<uint8_t>(UserRole::Member));
+static_assert(static_cast<uint8_t>(SquadRole::None) ==
+              static_cast<uint8_t>(UserRole::None));
+
+void SquadTracker::QueueUsers(const UserInfo* updated_users,
+                              const size_t updated_users_count) {
+  if (recorder_.IsRecording()) RecordUsers(updated_users, updated_users_count);
+  const bool queued =
+      pending_users_.Push(updated_users_count, [&](const size_t i) {
+        const auto& user = updated_users[i];
+        return UserDelta::Make(user.AccountName, user.JoinTime,
+                               static_cast<SquadRole>(user.Role),
+                               user.Subgroup, user.ReadyStatus);
+      });
+  if (!queued) {
+    logging::Squad("squad update queue is full, dropping {} user updates",
+                   updated_users_count);
+  }
+}
 
-void SquadTracker::UpdateUsers(const UserInfo* updated_users,
+void SquadTracker::RecordUsers(const UserInfo* updated_users,
                                const size_t updated_users_count) {
-  std::scoped_lock guard(cached_players_mutex_);
-  logging::Debug(
-      std::format("received squad callback with {} users",
-                  updated_users_count));
+  std::vector<trace::User> users(updated_users_count);
   for (size_t i = 0; i < updated_users_count; i++) {
-    const auto user = updated_users[i];
-    auto user_account_name = std::string(user.AccountName);
-    if (user_account_name.at(0) == ':') {
-      user_account_name.erase(0, 1);
-    }
-    logging::Debug(
-        std::format("updated user {} accountname: {} ready: {} role: {} "
-                    "jointime: {} subgroup: {}",
-                    i, user.AccountName, user.ReadyStatus,
-                    static_cast<uint8_t>(user.Role),
-                    user.JoinTime, user.Subgroup));
-    // User added/updated
-    if (user.Role != UserRole::None) {
-      if (user_account_name == globals::self_account_name) {
-        self_readied_ = user.ReadyStatus;
-      }
-      if (auto old_user_it = cached_players_.find(user_account_name);
-        old_user_it == cached_players_.end()) {
-        // User added
-        cached_players_.emplace(user_account_name, user);
-      } else {
-        // User updated
-        const auto old_user = old_user_it->second;
-        cached_players_.insert_or_assign(user_account_name, user);
-
-        if (user.Role == UserRole::SquadLeader) {
-          if (user.ReadyStatus && !old_user.ReadyStatus) {
-            // Squad leader has started a ready check
-            ReadyCheckStarted();
-          } else {
-            // Squad leader has ended a ready check, either via a complete
-            // ready check or by cancelling
-            ReadyCheckEnded();
-          }
-        } else {
-          if (AllPlayersReadied()) {
-            ReadyCheckCompleted();
-          }
-        }
-      }
-    }
-    // User removed
-    else {
-      if (user_account_name == globals::self_account_name) {
-        // Self left squad, reset cache
-        self_readied_ = false;
-        cached_players_.clear();
-        ReadyCheckEnded();
-      } else {
-        // Remove player from cache
-        cached_players_.erase(user_account_name);
-      }
-    }
+    const auto& user = updated_users[i];
+    users[i].account_name = user.AccountName ? user.AccountName : "";
+    users[i].join_time = user.JoinTime;
+    users[i].role = static_cast<uint8_t>(user.Role);
+    users[i].subgroup = user.Subgroup;
+    users[i].ready = user.ReadyStatus;
   }
+  recorder_.RecordSquadUpdate(users.data(), users.size());
 }
 
-void SquadTracker::Tick() {
-  // no active ready check
-  if (!in_ready_check_) return;
-  // self is already readied up
-  if (self_readied_) return;
-  Settings::instance([this](const Settings& s) {
-    // nag is disabled
-    if (!s.settings.ready_check_nag) return;
-    // nag time has not passed
-    if (std::chrono::steady_clock::now() < ready_check_nag_time_) return;
-    // nag time has passed, time to nag
-    SetReadyCheckNagTime();
-    FlashWindow();
-    AudioPlayer::instance([](const AudioPlayer& i) { i.PlayReadyCheck(); });
+void SquadTracker::ProcessQueuedUsers() {
+  if (pending_users_.TakeResync()) {
+    logging::Squad("lost squad updates, resetting the squad until it updates");
+    tracker_.Reset();
+    next_deadline_ = tracker_.NextDeadline();
+  }
+  pending_users_.Drain([this](const UserDelta* users, const size_t count) {
+    UpdateUsers(users, count);
   });
 }
 
+void SquadTracker::UpdateUsers(const UserDelta* updated_users,
+                               const size_t updated_users_count) {
+  const ScopedTimer timer(globals::metrics, Metric::SquadUpdate);
+  globals::metrics.Add(Metric::UsersUpdated, updated_users_count);
+  if (logging::Enabled(logging::Level::Debug)) {
+    logging::Debug("received squad callback with {} users",
+                   updated_users_count);
+    for (size_t i = 0; i < updated_users_count; i++) {
+      const auto& user = updated_users[i];
+      logging::Debug(
+          "updated user {} accountname: {} ready: {} role: {} "
+          "jointime: {} subgroup: {}",
+          i, user.AccountName(), user.ready, static_cast<uint8_t>(user.role),
+          user.join_time, user.subgroup);
+    }
+  }
+  UpdateConfig();
+  const auto transition = tracker_.ApplyBatch(
+      updated_users, updated_users_count, globals::self_account_name);
+  if (transition.dropped_users != 0) {
+    logging::Squad("squad roster is full, ignored {} user updates",
+                   transition.dropped_users);
+  }
+
+  switch (transition.event) {
+    case SquadEvent::ReadyCheckStarted:
+      logging::Debug("ready check has started");
+      break;
+    case SquadEvent::ReadyCheckCompleted:
+      logging::Debug("squad is ready");
+      break;
+    case SquadEvent::ReadyCheckEnded:
+      logging::Debug("ready check has ended");
+      break;
+    case SquadEvent::None:
+      Roster::ForEachSlot(transition.readied_subgroups, [](const int i) {
+        logging::Debug("subgroup {} is ready", i + 1);
+      });
+      break;
+  }
+  next_deadline_ = tracker_.NextDeadline();
+}
+
+void SquadTracker::Tick(const bool not_charsel_or_loading) {
+  const ScopedTimer timer(globals::metrics, Metric::SquadTick);
+  // nothing scheduled, the usual case outside of a ready check
+  if (next_deadline_ == ReadyCheckTracker::kNoDeadline) return;
+  // hold timers on loading screens and character select, anything that came
+  // due fires once we are back in game
+  if (!not_charsel_or_loading) return;
+  if (Clock::now() < next_deadline_) return;
+
+  UpdateConfig();
+  tracker_.Tick();
+  next_deadline_ = tracker_.NextDeadline();
+}
+
+void SquadTracker::UpdateConfig() {
+  const auto& settings = Settings::instance();
+  const uint64_t version = settings.Version();
+  if (version == settings_version_) return;
+  settings_version_ = version;
+  const auto s = settings.Get();
+  tracker_.SetConfig({s->flash_window, s->ready_check_nag,
+                      s->ready_check_nag_interval_seconds});
+}
+
 void SquadTracker::Draw() {
   if (!debug_window_visible_) {
     return;
   }
+  const ScopedTimer timer(globals::metrics, Metric::DebugWindow);
 
   ImGuiWindowFlags imGuiWindowFlags =
       ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoFocusOnAppearing |
@@ -103,50 +145,62 @@ void SquadTracker::Draw() {
   ImGui::TableSetupColumn("Ready");
   ImGui::TableHeadersRow();
 
-  {
-    std::scoped_lock guard(cached_players_mutex_);
-    for (auto& [account_name, user_info] : cached_players_) {
-      ImGui::TableNextRow();
-      ImGui::TableNextColumn();
-      ImGui::TextUnformatted(account_name.c_str());
-      ImGui::TableNextColumn();
-      ImGui::TextUnformatted(
-          std::format("{}", static_cast<uint8_t>(user_info.Role)).c_str());
-      ImGui::TableNextColumn();
-      ImGui::TextUnformatted(std::format("{}", user_info.Subgroup + 1).c_str());
-      ImGui::TableNextColumn();
-      if (user_info.ReadyStatus) {
-        ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "Ready");
-      } else {
-        ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Not Ready");
-      }
+  // render from the published snapshot, the update path never waits on us
+  const auto snapshot = tracker_.Snapshot();
+  const auto& players = snapshot->players;
+  players.ForEach([&players](const int slot) {
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted(players.AccountName(slot).data());
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted(
+        std::format("{}", static_cast<uint8_t>(players.Role(slot)))
+            .c_str());
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted(
+        std::format("{}", players.Subgroup(slot) + 1).c_str());
+    ImGui::TableNextColumn();
+    if (players.Ready(slot)) {
+      ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "Ready");
+    } else {
+      ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Not Ready");
     }
-  }
+  });
 
   ImGui::EndTable();
 
   ImGui::Separator();
   ImGui::TextDisabled("Internal Variables");
 
-  if (in_ready_check_) {
+  if (snapshot->in_ready_check) {
     ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "in_ready_check_");
   } else {
     ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "in_ready_check_");
   }
 
-  if (self_readied_) {
+  if (snapshot->self_readied) {
     ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "self_readied_");
   } else {
     ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "self_readied_");
   }
 
+  ImGui::TextUnformatted(
+      std::format("{}/{} ready, {} not ready",
+                  std::popcount(players.EligibleMask() &
+                                players.ReadyMask()),
+                  std::popcount(players.EligibleMask()),
+                  players.NotReadyCount())
+          .c_str());
+  ImGui::TextUnformatted(
+      std::format("{:#x} subgroups_readied_", snapshot->subgroups_readied)
+          .c_str());
   ImGui::TextUnformatted(
       std::format("{} ready_check_start_time_",
-                  ready_check_start_time_.time_since_epoch().count())
+                  snapshot->ready_check_start_time.time_since_epoch().count())
       .c_str());
   ImGui::TextUnformatted(
       std::format("{} ready_check_nag_time_",
-                  ready_check_nag_time_.time_since_epoch().count())
+                  snapshot->ready_check_nag_time.time_since_epoch().count())
       .c_str());
   ImGui::TextUnformatted(
       std::format("{} current_time",
@@ -156,92 +210,277 @@ void SquadTracker::Draw() {
   ImGui::Separator();
   ImGui::TextDisabled("Settings");
 
-  Settings::instance([this](const Settings& s) {
-    if (s.settings.ready_check_nag) {
-      ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "ready_check_nag");
-    } else {
-      ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "ready_check_nag");
-    }
+  const auto s = Settings::instance().Get();
+  if (s->ready_check_nag) {
+    ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "ready_check_nag");
+  } else {
+    ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "ready_check_nag");
+  }
 
-    if (s.settings.ready_check_nag_in_combat) {
-      ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f),
-                         "ready_check_nag_in_combat");
-    } else {
-      ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f),
-                         "ready_check_nag_in_combat");
-    }
+  if (s->ready_check_nag_in_combat) {
+    ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f),
+                       "ready_check_nag_in_combat");
+  } else {
+    ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f),
+                       "ready_check_nag_in_combat");
+  }
 
-    ImGui::TextUnformatted(
-        std::format(
-            "{} ready_check_nag_interval_seconds",
-            s.settings.ready_check_nag_interval_seconds)
-            .c_str());
-  });
+  ImGui::TextUnformatted(
+      std::format("{} ready_check_nag_interval_seconds",
+                  s->ready_check_nag_interval_seconds)
+          .c_str());
+  ImGui::TextUnformatted(
+      std::format("{} settings version", Settings::instance().Version())
+          .c_str());
+
+  DrawLatency();
+  DrawStartup();
+  DrawMetrics();
+  DrawPlayback();
+  DrawRecorder();
 
   ImGui::End();
 }
 
-void SquadTracker::ReadyCheckStarted() {
-  logging::Debug("ready check has started");
-  in_ready_check_ = true;
-  ready_check_start_time_ = std::chrono::steady_clock::now();
-  SetReadyCheckNagTime();
-  FlashWindow();
-  AudioPlayer::instance([](const AudioPlayer& i) { i.PlayReadyCheck(); });
+void SquadTracker::DrawLatency() {
+  ImGui::Separator();
+  ImGui::TextDisabled("Ready Latency");
+
+  const auto& latency = tracker_.Latency();
+  const auto& squad = latency.SquadHistogram();
+  ImGui::TextUnformatted(
+      std::format("squad ready after p50 {}ms p90 {}ms p99 {}ms max {}ms "
+                  "({} checks)",
+                  squad.Percentile(0.5), squad.Percentile(0.9),
+                  squad.Percentile(0.99), squad.Max(), squad.Count())
+          .c_str());
+
+  if (ImGui::BeginTable("readylatency", 5)) {
+    ImGui::TableSetupColumn("Account");
+    ImGui::TableSetupColumn("Checks");
+    ImGui::TableSetupColumn("p50");
+    ImGui::TableSetupColumn("p90");
+    ImGui::TableSetupColumn("Max");
+    ImGui::TableHeadersRow();
+    latency.ForEachAccount([](const ReadyLatency::Account& account) {
+      const auto& histogram = account.histogram;
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(account.AccountName().data());
+      ImGui::TableNextColumn();
+      ImGui::Text("%u", histogram.Count());
+      ImGui::TableNextColumn();
+      ImGui::Text("%ums", histogram.Percentile(0.5));
+      ImGui::TableNextColumn();
+      ImGui::Text("%ums", histogram.Percentile(0.9));
+      ImGui::TableNextColumn();
+      ImGui::Text("%ums", histogram.Max());
+    });
+    ImGui::EndTable();
+  }
+
+  if (ImGui::TreeNode("Recent ready checks")) {
+    latency.ForEachRecentCheck([](const ReadyCheckSummary& check) {
+      ImGui::TextUnformatted(
+          std::format("{} after {}ms, {}/{} readied, slowest {} ({}ms)",
+                      check.completed ? "ready" : "ended", check.duration_ms,
+                      check.readied, check.members,
+                      check.slowest_account_name.data(), check.slowest_ms)
+              .c_str());
+    });
+    ImGui::TreePop();
+  }
 }
 
-void SquadTracker::ReadyCheckCompleted() {
-  logging::Debug("squad is ready");
-  ready_check_nag_time_ = {};
-  FlashWindow();
-  AudioPlayer::instance([](const AudioPlayer& i) { i.PlaySquadReady(); });
-  ReadyCheckEnded();
+void SquadTracker::DrawStartup() {
+  ImGui::Separator();
+  ImGui::TextDisabled("Startup");
+
+  if (ImGui::BeginTable("startup", 4)) {
+    ImGui::TableSetupColumn("Stage");
+    ImGui::TableSetupColumn("Start");
+    ImGui::TableSetupColumn("Duration");
+    ImGui::TableSetupColumn("Status");
+    ImGui::TableHeadersRow();
+    const auto& timings = startup::Timings();
+    for (size_t i = 0; i < StartupTimings::kStages; i++) {
+      const auto stage = static_cast<StartupStage>(i);
+      const auto entry = timings.Get(stage);
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(StartupStageName(stage));
+      if (entry.status == StartupTimings::Status::Pending) {
+        ImGui::TableNextColumn();
+        ImGui::TableNextColumn();
+        ImGui::TableNextColumn();
+        ImGui::TextDisabled("Pending");
+        continue;
+      }
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1fms", entry.start.count() / 1000.0);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1fms", entry.duration.count() / 1000.0);
+      ImGui::TableNextColumn();
+      if (entry.status == StartupTimings::Status::Succeeded) {
+        ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "OK");
+      } else {
+        ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Failed");
+      }
+    }
+    ImGui::EndTable();
+  }
 }
 
-void SquadTracker::ReadyCheckEnded() {
-  logging::Debug("ready check has ended");
-  in_ready_check_ = false;
-  ready_check_start_time_ = {};
+void SquadTracker::DrawMetrics() {
+  ImGui::Separator();
+  ImGui::TextDisabled("Cost per Frame");
+
+  auto& metrics = globals::metrics;
+  ImGui::TextUnformatted(std::format("over the last {} frames, times in us",
+                                     metrics.FramesKept())
+                             .c_str());
+  if (ImGui::BeginTable("metrics", 6)) {
+    ImGui::TableSetupColumn("Metric");
+    ImGui::TableSetupColumn("Last");
+    ImGui::TableSetupColumn("Average");
+    ImGui::TableSetupColumn("Max");
+    ImGui::TableSetupColumn("Calls");
+    ImGui::TableSetupColumn("Slowest call");
+    ImGui::TableHeadersRow();
+    for (size_t i = 0; i < Metrics::kMetrics; i++) {
+      const auto metric = static_cast<Metric>(i);
+      const auto summary = metrics.Summarize(metric);
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(MetricName(metric));
+      if (!IsTimer(metric)) {
+        // counters only add up, shown as their value per frame
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", summary.last_total);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", summary.average_total);
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", summary.max_total);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", summary.average_count);
+        ImGui::TableNextColumn();
+        continue;
+      }
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", summary.last_total / 1000.0);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", summary.average_total / 1000.0);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", summary.max_total / 1000.0);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", summary.average_count);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", summary.max_call / 1000.0);
+    }
+    ImGui::EndTable();
+  }
+
+  if (!capture_pending_) {
+    if (ImGui::Button("Start Capture")) {
+      metrics.StartCapture();
+      capture_pending_ = true;
+    }
+    return;
+  }
+  if (ImGui::Button("Save Capture")) {
+    metrics.StopCapture();
+    capture_pending_ = false;
+    const auto path = std::format(
+        "addons\\arcdps\\arcdps_squad_ready_{}.json",
+        std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+    if (metrics.WriteChromeTrace(path)) {
+      logging::Squad("saved {} calls as a Chrome trace to {}",
+                     metrics.CapturedEvents(), path);
+    } else {
+      logging::Squad("failed to write Chrome trace {}", path);
+    }
+  }
+  ImGui::SameLine();
+  ImGui::Text("%zu/%zu calls%s", metrics.CapturedEvents(),
+              Metrics::kCaptureEvents, metrics.Capturing() ? "" : ", full");
 }
 
-void SquadTracker::SetReadyCheckNagTime() {
-  Settings::instance([this](const Settings& s) {
-    ready_check_nag_time_ =
-        std::chrono::steady_clock::now() +
-        std::chrono::milliseconds(static_cast<uint64_t>(
-            1000 *
-            s.settings.ready_check_nag_interval_seconds));
+void SquadTracker::DrawPlayback() {
+  ImGui::Separator();
+  ImGui::TextDisabled("Playback");
+  if (!startup::AudioReady()) {
+    ImGui::TextDisabled("Loading audio...");
+    return;
+  }
+
+  std::string summary;
+  std::array<std::string, kSoundEvents> playback;
+  AudioPlayer::instance([&](AudioPlayer& i) {
+    summary = i.SoundBankSummary();
+    for (size_t event = 0; event < kSoundEvents; event++) {
+      playback[event] = i.SoundPlayback(static_cast<SoundEvent>(event));
+    }
   });
+  ImGui::TextUnformatted(summary.c_str());
+  for (size_t event = 0; event < kSoundEvents; event++) {
+    ImGui::TextUnformatted(
+        std::format("{}: {}", SoundEventName(static_cast<SoundEvent>(event)),
+                    playback[event])
+            .c_str());
+  }
 }
 
-bool SquadTracker::AllPlayersReadied() {
-  // iterate through all cachedPlayers, and check readyStatus == true and
-  // in squad
-  for (auto const& [accountName, user] : cached_players_) {
-    if (user.Role != UserRole::SquadLeader &&
-        user.Role != UserRole::Lieutenant && user.Role != UserRole::Member) {
-      logging::Debug(std::format("ignoring {} because they are role {}",
-                                 accountName, static_cast<int>(user.Role)));
-      continue;
+void SquadTracker::DrawRecorder() {
+  ImGui::Separator();
+  ImGui::TextDisabled("Trace Recording");
+
+  if (!recorder_.IsRecording()) {
+    if (ImGui::Button("Start Recording")) {
+      const auto path = std::format(
+          "addons\\arcdps\\arcdps_squad_ready_{}.srtrace",
+          std::chrono::duration_cast<std::chrono::seconds>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count());
+      if (recorder_.Start(path, globals::self_account_name)) {
+        logging::Squad("recording squad updates to {}", path);
+      } else {
+        logging::Squad("failed to open trace file {}", path);
+      }
     }
-    if (!user.ReadyStatus) {
-      logging::Debug(std::format("squad not ready due to {}", accountName));
-      return false;
+  } else {
+    if (ImGui::Button("Stop Recording")) {
+      recorder_.Stop();
+      logging::Squad("stopped recording squad updates to {}",
+                     recorder_.Path());
     }
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Recording to %s",
+                       recorder_.Path().c_str());
   }
-  logging::Debug("all players are readied");
-  return true;
+}
+
+void SquadTracker::Play(const SoundEvent event) {
+  // the flash still happens, only the sound is skipped
+  if (!startup::AudioReady()) {
+    logging::Debug("audio is not ready, not playing {}",
+                   SoundEventName(event));
+    return;
+  }
+  AudioPlayer::instance([&](const AudioPlayer& i) { i.Play(event); });
 }
 
 void SquadTracker::FlashWindow() {
-  Settings::instance([](const Settings& s) {
-    if (!s.settings.flash_window) return;
-    const auto wnd = globals::some_window;
-    if (wnd == nullptr) {
-      return;
-    }
-    FLASHWINFO flash_info{sizeof(flash_info), wnd,
-                          FLASHW_ALL | FLASHW_TIMERNOFG, 100, 0};
-    FlashWindowEx(&flash_info);
-  });
+  const auto wnd = globals::some_window;
+  if (wnd == nullptr) {
+    return;
+  }
+  FLASHWINFO flash_info{sizeof(flash_info), wnd,
+                        FLASHW_ALL | FLASHW_TIMERNOFG, 100, 0};
+  FlashWindowEx(&flash_info);
+}
+
+SquadTracker::Clock::time_point SquadTracker::Now() const {
+  return Clock::now();
 }
@@ -1,37 +1,60 @@
 #pragma once
 
-#include <map>
-#include <mutex>
-
 #include "Audio.h"
+#include "core/ReadyCheckTracker.h"
+#include "core/SquadUpdateQueue.h"
+#include "core/Trace.h"
 #include "unofficial_extras/Definitions.h"
 
-class SquadTracker {
-  std::map<std::string, UserInfo> cached_players_;
-  std::mutex cached_players_mutex_;
-  std::chrono::time_point<std::chrono::steady_clock> ready_check_start_time_;
-  std::chrono::time_point<std::chrono::steady_clock> ready_check_nag_time_;
-  bool in_ready_check_;
-  bool self_readied_;
+// Squad state is only touched from the render thread. Updates from the
+// unofficial extras thread are copied into pending_users_ by QueueUsers and
+// applied by ProcessQueuedUsers at the start of the frame. If the queue
+// overflows, the squad is forgotten and rebuilt from the updates that follow.
+//
+// The ready check logic itself lives in the platform-neutral
+// ReadyCheckTracker, this class provides its audio, window and clock sinks.
+class SquadTracker final : AudioSink, WindowSink, ClockSink {
+  SquadUpdateQueue pending_users_;
+  ReadyCheckTracker tracker_;
+  // cached copy of tracker_.NextDeadline() for the per-frame check
+  Clock::time_point next_deadline_ = ReadyCheckTracker::kNoDeadline;
+  // Settings::Version() the tracker config was last copied from
+  uint64_t settings_version_ = 0;
+  trace::Recorder recorder_;
+  // a metrics capture was started and not saved yet
+  bool capture_pending_ = false;
   bool debug_window_visible_;
 
  public:
   SquadTracker()
-      : in_ready_check_(false),
-        self_readied_(false),
+      : tracker_(*this, *this, *this),
         debug_window_visible_(false)
   {}
-  void UpdateUsers(const UserInfo* updated_users, size_t updated_users_count);
-  void Tick();
+  // Called from the unofficial extras thread.
+  void QueueUsers(const UserInfo* updated_users, size_t updated_users_count);
+  void ProcessQueuedUsers();
+  // Runs the tracker's timers once due, called every frame.
+  void Tick(bool not_charsel_or_loading);
   void Draw();
 
   void MakeDebugWindowVisible() { debug_window_visible_ = true; }
+  // Latest published squad state, for UI outside the debug window.
+  SnapshotPublisher<SquadSnapshot>::Reader Snapshot() const {
+    return tracker_.Snapshot();
+  }
 
 private:
-  void ReadyCheckStarted();
-  void ReadyCheckCompleted();
-  void ReadyCheckEnded();
-  void SetReadyCheckNagTime();
-  bool AllPlayersReadied();
-  static void FlashWindow();
+  void UpdateUsers(const UserDelta* updated_users, size_t updated_users_count);
+  void RecordUsers(const UserInfo* updated_users, size_t updated_users_count);
+  void DrawLatency();
+  void DrawStartup();
+  void DrawMetrics();
+  void DrawPlayback();
+  void DrawRecorder();
+  void UpdateConfig();
+
+  // AudioSink, WindowSink and ClockSink
+  void Play(SoundEvent event) override;
+  void FlashWindow() override;
+  Clock::time_point Now() const override;
 };
@@ -0,0 +1,109 @@
+#include "Startup.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "Audio.h"
+#include "AudioSettings.h"
+#include "Globals.h"
+#include "Logging.h"
+#include "Settings.h"
+#include "extension/UpdateChecker.h"
+
+namespace startup {
+namespace {
+
+std::unique_ptr<StartupTimings> timings;
+std::thread audio_worker;
+std::thread update_worker;
+std::atomic<bool> ready = false;
+std::atomic<bool> update_check_done = false;
+
+void LoadSettingsAndAudio() {
+  timings->Measure(StartupStage::Settings, [] {
+    Settings::instance().load();
+    return true;
+  });
+
+  auto& audio_player = AudioPlayer::instance();
+  {
+    const auto settings = Settings::instance().Get();
+    logging::SetDebugEnabled(settings->debug_logging);
+    audio_player.Configure(ResolveAudioConfig(*settings));
+  }
+  const bool engine_ready =
+      timings->Measure(StartupStage::AudioContext,
+                       [&] { return audio_player.InitContext(); }) &&
+      timings->Measure(StartupStage::DeviceEnumeration,
+                       [&] { return audio_player.OpenOutputDevice(); }) &&
+      timings->Measure(StartupStage::AudioEngine,
+                       [&] { return audio_player.InitEngine(); });
+  if (engine_ready) {
+    // distinct sounds decode in parallel
+    timings->Measure(StartupStage::Sounds,
+                     [&] { return audio_player.LoadSounds(); });
+  } else {
+    logging::Squad("Audio failed to initialize, sounds will not play");
+  }
+}
+
+void CheckForUpdate(
+    const std::optional<UpdateCheckerBase::Version>& current_version) {
+  timings->Measure(StartupStage::UpdateCheck, [&] {
+    UpdateChecker::instance().ClearFiles(globals::self_dll);
+    if (!current_version) return false;
+    globals::update_state = UpdateChecker::instance().CheckForUpdate(
+        globals::self_dll, current_version.value(),
+        "cheahjs/arcdps-squad-ready-plugin", false);
+    return globals::update_state != nullptr;
+  });
+}
+
+}  // namespace
+
+void Begin() { timings = std::make_unique<StartupTimings>(); }
+
+void Start(const std::optional<UpdateCheckerBase::Version>& current_version) {
+  timings->Record(StartupStage::Exports, timings->Origin(),
+                  StartupTimings::Clock::now(), true);
+
+  audio_worker = std::thread([] {
+    try {
+      LoadSettingsAndAudio();
+    } catch (const std::exception& e) {
+      logging::Squad("Failed to load: {}", e.what());
+    }
+    // unblock the UI even if loading failed
+    ready.store(true, std::memory_order_release);
+  });
+
+  update_worker = std::thread([current_version] {
+    try {
+      CheckForUpdate(current_version);
+    } catch (const std::exception& e) {
+      logging::Squad("Failed to check for updates: {}", e.what());
+    }
+    update_check_done.store(true, std::memory_order_release);
+  });
+}
+
+void Wait() {
+  if (audio_worker.joinable()) audio_worker.join();
+  if (update_worker.joinable()) update_worker.join();
+}
+
+bool Ready() { return ready.load(std::memory_order_acquire); }
+
+bool AudioReady() {
+  // from the player rather than startup, so Reset Audio can bring it back
+  return Ready() && AudioPlayer::instance().EngineReady();
+}
+
+bool UpdateCheckDone() {
+  return update_check_done.load(std::memory_order_acquire);
+}
+
+const StartupTimings& Timings() { return *timings; }
+
+}  // namespace startup
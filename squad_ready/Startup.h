@@ -0,0 +1,30 @@
+#pragma once
+
+#include <optional>
+
+#include "core/StartupTimings.h"
+#include "extension/UpdateCheckerBase.h"
+
+// Everything mod_init used to do before returning its exports, moved to
+// background workers: settings, audio (sounds decoded in parallel) on one,
+// update file cleanup and the update check on another.
+namespace startup {
+
+// Called at the very start of mod_init.
+void Begin();
+// Called right before mod_init returns, kicks off the background stages.
+void Start(const std::optional<UpdateCheckerBase::Version>& current_version);
+// Blocks until every background stage has finished, for mod_release.
+void Wait();
+
+// Settings are loaded and the audio player is initialized, anything touching
+// either may run.
+bool Ready();
+// Ready, and the audio engine is running. Can change later, as the audio is
+// reset or fails to reopen.
+bool AudioReady();
+bool UpdateCheckDone();
+
+const StartupTimings& Timings();
+
+}  // namespace startup
@@ -0,0 +1,447 @@
+#include "WaveFile.h"
+
+#include <filesystem>
+#include <format>
+#include <utility>
+
+#include "Error.h"
+#include "Logging.h"
+#include "core/Resampler.h"
+#include "core/SoundLoadPolicy.h"
+
+#ifdef _WIN32
+#include "Globals.h"
+#endif
+
+namespace {
+
+// Reads just enough of the file to know how large it would be decoded, at the
+// engine's sample rate in f32 like the resource manager decodes it.
+SoundFileInfo ProbeSoundFile(const std::string& file_name, ma_engine* engine) {
+  SoundFileInfo info;
+  std::error_code error;
+  info.file_size = std::filesystem::file_size(file_name, error);
+  if (error) info.file_size = 0;
+
+  auto decoder_config = ma_decoder_config_init(
+      ma_format_f32, 0, engine ? ma_engine_get_sample_rate(engine) : 0);
+  ma_decoder decoder;
+  if (ma_decoder_init_file(file_name.c_str(), &decoder_config, &decoder) !=
+      MA_SUCCESS) {
+    return info;
+  }
+  ma_uint64 length_in_frames = 0;
+  if (ma_decoder_get_length_in_pcm_frames(&decoder, &length_in_frames) ==
+      MA_SUCCESS) {
+    info.length_in_frames = length_in_frames;
+  }
+  info.channels = decoder.outputChannels;
+  info.sample_rate = decoder.outputSampleRate;
+  ma_decoder_uninit(&decoder);
+  return info;
+}
+
+// Reads the rest of an f32 decoder.
+std::vector<float> DecodeAll(ma_decoder& decoder, ma_uint64& frame_count) {
+  const auto channels = decoder.outputChannels;
+  constexpr ma_uint64 kChunkFrames = 4096;
+  std::vector<float> samples;
+  frame_count = 0;
+  while (true) {
+    samples.resize((frame_count + kChunkFrames) * channels);
+    ma_uint64 read = 0;
+    const auto result = ma_decoder_read_pcm_frames(
+        &decoder, samples.data() + frame_count * channels, kChunkFrames, &read);
+    frame_count += read;
+    if (result != MA_SUCCESS || read < kChunkFrames) break;
+  }
+  samples.resize(frame_count * channels);
+  return samples;
+}
+
+// Decodes the whole file in the engine's format, empty on failure.
+std::vector<float> DecodeSoundFile(const std::string& file_name,
+                                   ma_engine* engine, ma_uint64& frame_count) {
+  auto decoder_config =
+      ma_decoder_config_init(ma_format_f32, ma_engine_get_channels(engine),
+                             ma_engine_get_sample_rate(engine));
+  ma_decoder decoder;
+  if (ma_decoder_init_file(file_name.c_str(), &decoder_config, &decoder) !=
+      MA_SUCCESS) {
+    return {};
+  }
+  auto samples = DecodeAll(decoder, frame_count);
+  ma_decoder_uninit(&decoder);
+  return samples;
+}
+
+// Voices forward to their inner source, noting the first read after each
+// trigger for the latency stats.
+ma_result ReadVoice(ma_data_source* source, void* frames,
+                    const ma_uint64 frame_count, ma_uint64* frames_read) {
+  auto& voice = *static_cast<WaveFile::Voice*>(source);
+  const auto result = ma_data_source_read_pcm_frames(voice.inner, frames,
+                                                     frame_count, frames_read);
+  if (voice.triggered_at.load(std::memory_order_relaxed) != 0) {
+    if (const auto triggered_at = voice.triggered_at.exchange(0);
+        triggered_at != 0) {
+      voice.latency->Record(triggered_at);
+    }
+  }
+  return result;
+}
+
+ma_result SeekVoice(ma_data_source* source, const ma_uint64 frame) {
+  return ma_data_source_seek_to_pcm_frame(
+      static_cast<WaveFile::Voice*>(source)->inner, frame);
+}
+
+ma_result GetVoiceDataFormat(ma_data_source* source, ma_format* format,
+                             ma_uint32* channels, ma_uint32* sample_rate,
+                             ma_channel* channel_map,
+                             const size_t channel_map_capacity) {
+  return ma_data_source_get_data_format(
+      static_cast<WaveFile::Voice*>(source)->inner, format, channels,
+      sample_rate, channel_map, channel_map_capacity);
+}
+
+ma_result GetVoiceCursor(ma_data_source* source, ma_uint64* cursor) {
+  return ma_data_source_get_cursor_in_pcm_frames(
+      static_cast<WaveFile::Voice*>(source)->inner, cursor);
+}
+
+ma_result GetVoiceLength(ma_data_source* source, ma_uint64* length) {
+  return ma_data_source_get_length_in_pcm_frames(
+      static_cast<WaveFile::Voice*>(source)->inner, length);
+}
+
+constexpr ma_data_source_vtable kVoiceVtable = {
+    ReadVoice, SeekVoice, GetVoiceDataFormat, GetVoiceCursor, GetVoiceLength,
+    nullptr,   0,
+};
+
+// An ma_audio_buffer reading frame_count frames of samples in place.
+ma_result InitSharedBuffer(WaveFile::Voice& voice, const float* samples,
+                           const ma_uint64 frame_count,
+                           const ma_uint32 channels,
+                           const ma_uint32 sample_rate) {
+  auto buffer_config = ma_audio_buffer_config_init(
+      ma_format_f32, channels, frame_count, samples, nullptr);
+  buffer_config.sampleRate = sample_rate;
+  voice.buffer = std::make_unique<ma_audio_buffer>();
+  if (const auto result =
+          ma_audio_buffer_init(&buffer_config, voice.buffer.get());
+      result != MA_SUCCESS) {
+    voice.buffer.reset();
+    return result;
+  }
+  voice.inner = voice.buffer.get();
+  return MA_SUCCESS;
+}
+
+}  // namespace
+
+std::string FormatBytes(const uint64_t bytes) {
+  if (bytes >= 1 << 20) return std::format("{:.1f} MB", bytes / 1048576.0);
+  return std::format("{:.0f} KB", bytes / 1024.0);
+}
+
+WaveFile::WaveFile() { valid_ = false; }
+
+WaveFile::WaveFile(std::string error_message)
+    : error_message_(std::move(error_message)) {
+  valid_ = false;
+}
+
+ma_result WaveFile::InitVoices(
+    ma_engine* engine, const size_t count,
+    const std::function<ma_result(Voice&)>& init_source) {
+  pool_ = VoicePool<kMaxVoices>(count);
+  for (size_t i = 0; i < pool_.Voices(); i++) {
+    auto& voice = voices_[i];
+    voice = std::make_unique<Voice>();
+    voice->latency = &latency_;
+    if (const auto result = init_source(*voice); result != MA_SUCCESS) {
+      return result;
+    }
+
+    auto source_config = ma_data_source_config_init();
+    source_config.vtable = &kVoiceVtable;
+    if (const auto result = ma_data_source_init(&source_config, &voice->base);
+        result != MA_SUCCESS) {
+      return result;
+    }
+    voice->source_initialized = true;
+
+    if (const auto result = ma_sound_init_from_data_source(
+            engine, &voice->base, 0, nullptr, &voice->sound);
+        result != MA_SUCCESS) {
+      return result;
+    }
+    voice->sound_initialized = true;
+  }
+  return MA_SUCCESS;
+}
+
+void WaveFile::DestroyVoices() {
+  for (auto& voice : voices_) {
+    if (!voice) continue;
+    if (voice->sound_initialized) {
+      logging::MiniAudioError(ma_sound_stop(&voice->sound),
+                              "Failed to stop sound");
+      ma_sound_uninit(&voice->sound);
+    }
+    if (voice->source_initialized) ma_data_source_uninit(&voice->base);
+    if (voice->buffer) ma_audio_buffer_uninit(voice->buffer.get());
+    if (voice->resource) {
+      ma_resource_manager_data_source_uninit(voice->resource.get());
+    }
+    voice.reset();
+  }
+  // unmapped only once nothing reads from it
+  cached_.reset();
+}
+
+void WaveFile::ApplyAnalysis(const PcmAnalysis& analysis,
+                             const uint32_t sample_rate) {
+  start_frame_ = pcm_analysis::TrimFrames(analysis, sample_rate);
+  normalization_gain_ = pcm_analysis::NormalizationGain(analysis);
+  trimmed_milliseconds_ =
+      sample_rate == 0
+          ? 0.0f
+          : 1000.0f * start_frame_ / static_cast<float>(sample_rate);
+  analyzed_ = true;
+}
+
+ma_result WaveFile::InitConverted(ma_engine* engine, const float* samples,
+                                  ma_uint64 frame_count, ma_uint32 channels,
+                                  ma_uint32 sample_rate) {
+  const auto engine_channels = ma_engine_get_channels(engine);
+  const auto engine_sample_rate = ma_engine_get_sample_rate(engine);
+  if (channels != engine_channels || sample_rate != engine_sample_rate) {
+    // samples may be converted_ itself, it is only replaced once read
+    converted_ = resampler::Convert(samples, frame_count, channels, sample_rate,
+                                    engine_channels, engine_sample_rate);
+    channels = engine_channels;
+    sample_rate = engine_sample_rate;
+    frame_count = converted_.size() / channels;
+  }
+  if (!converted_.empty()) samples = converted_.data();
+
+  ApplyAnalysis(
+      pcm_analysis::Analyze(samples, frame_count, channels, sample_rate),
+      sample_rate);
+  return InitVoices(engine, kMaxVoices, [&](Voice& voice) {
+    return InitSharedBuffer(voice, samples, frame_count, channels,
+                            sample_rate);
+  });
+}
+
+bool WaveFile::InitFromCache(const std::string& file_name, ma_engine* engine,
+                             PcmCache& cache) {
+  const auto channels = ma_engine_get_channels(engine);
+  const auto key = PcmCache::MakeKey(file_name, channels,
+                                     ma_engine_get_sample_rate(engine));
+  if (!key) return false;
+
+  auto entry = cache.Find(*key);
+  bool hit = entry.has_value();
+  if (!hit) {
+    ma_uint64 frame_count = 0;
+    const auto samples = DecodeSoundFile(file_name, engine, frame_count);
+    if (frame_count == 0) return false;
+    entry = cache.Store(
+        *key, samples.data(), frame_count,
+        pcm_analysis::Analyze(samples.data(), frame_count, channels,
+                              key->sample_rate));
+    if (!entry) {
+      logging::Debug("failed to cache {} in {}", file_name,
+                     cache.Directory().string());
+      return false;
+    }
+  }
+
+  // every voice reads the same mapping
+  cached_ = std::move(entry);
+  ApplyAnalysis(cached_->analysis, key->sample_rate);
+  if (InitVoices(engine, kMaxVoices, [&](Voice& voice) {
+        return InitSharedBuffer(voice, cached_->samples, cached_->frame_count,
+                                channels, key->sample_rate);
+      }) != MA_SUCCESS) {
+    DestroyVoices();
+    return false;
+  }
+
+  // mapped pages are shared with the page cache and only resident once played
+  resident_bytes_ = cached_->file->Size();
+  memory_description_ = std::format("{}, {} mapped", hit ? "cached" : "decoded",
+                                    FormatBytes(resident_bytes_));
+  return true;
+}
+
+WaveFile::WaveFile(const std::string& file_name, ma_engine* engine,
+                   PcmCache* cache) {
+  valid_ = false;
+
+  const auto info = ProbeSoundFile(file_name, engine);
+  const auto mode = sound_load_policy::Choose(info);
+  if (mode == SoundLoadMode::Decode && cache && engine &&
+      InitFromCache(file_name, engine, *cache)) {
+    logging::Debug("loaded {} ({})", file_name, memory_description_);
+    valid_ = true;
+    return;
+  }
+
+  // Decoded voices share the resource manager's one decoded copy of the
+  // file. Each streamed voice would page its own copy, so a long sound gets
+  // a single voice and a retrigger restarts it.
+  const ma_uint32 flags = mode == SoundLoadMode::Stream
+                              ? MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_STREAM
+                              : MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_DECODE;
+  const size_t voices = mode == SoundLoadMode::Stream ? 1 : kMaxVoices;
+  if (const auto result = InitVoices(
+          engine, voices,
+          [&](Voice& voice) -> ma_result {
+            voice.resource =
+                std::make_unique<ma_resource_manager_data_source>();
+            if (const auto result = ma_resource_manager_data_source_init(
+                    ma_engine_get_resource_manager(engine), file_name.c_str(),
+                    flags, nullptr, voice.resource.get());
+                result != MA_SUCCESS) {
+              voice.resource.reset();
+              return result;
+            }
+            voice.inner = voice.resource.get();
+            return MA_SUCCESS;
+          });
+      result != MA_SUCCESS) {
+    error_message_ =
+        std::format("Failed to load: {}", error::humanize_ma_result(result));
+    logging::MiniAudioError(result,
+                            std::format("Failed to load {}", file_name));
+    return;
+  }
+
+  if (mode == SoundLoadMode::Stream) {
+    resident_bytes_ = sound_load_policy::StreamedBytes(info);
+    memory_description_ =
+        std::format("streamed, {} buffered", FormatBytes(resident_bytes_));
+  } else {
+    resident_bytes_ = sound_load_policy::DecodedBytes(info);
+    memory_description_ =
+        std::format("decoded, {}", FormatBytes(resident_bytes_));
+  }
+  logging::Debug("loaded {} ({})", file_name, memory_description_);
+  valid_ = true;
+}
+
+#ifdef _WIN32
+WaveFile::WaveFile(LPWSTR resource, ma_engine* engine) {
+  valid_ = false;
+
+  const auto resource_info =
+      FindResource(globals::self_dll, resource, TEXT("WAVE"));
+  if (resource_info == nullptr) return;
+
+  const auto loaded_resource = LoadResource(globals::self_dll, resource_info);
+  if (loaded_resource == nullptr) return;
+
+  const auto resource_size = SizeofResource(globals::self_dll, resource_info);
+  if (resource_size == 0) return;
+
+  const auto resource_pointer = LockResource(loaded_resource);
+  if (resource_pointer == nullptr) return;
+
+  // decoded once at its native format and converted from there, rather than
+  // by the decoder's resampler
+  auto decoder_config = ma_decoder_config_init(ma_format_f32, 0, 0);
+  ma_decoder decoder;
+  if (const auto result = ma_decoder_init_memory(
+          resource_pointer, resource_size, &decoder_config, &decoder);
+      result != MA_SUCCESS) {
+    error_message_ = std::format("Internal error, failed to decode sound: {}",
+                                 error::humanize_ma_result(result));
+    logging::MiniAudioError(result, "Failed to decode sound");
+    return;
+  }
+  ma_uint64 frame_count = 0;
+  // kept as is if it already is in the engine's format
+  converted_ = DecodeAll(decoder, frame_count);
+  const auto channels = decoder.outputChannels;
+  const auto sample_rate = decoder.outputSampleRate;
+  ma_decoder_uninit(&decoder);
+
+  if (const auto result = InitConverted(engine, converted_.data(), frame_count,
+                                        channels, sample_rate);
+      result != MA_SUCCESS) {
+    error_message_ = std::format("Internal error, failed to init sound: {}",
+                                 error::humanize_ma_result(result));
+    logging::MiniAudioError(result, "Failed to init sound");
+    return;
+  }
+
+  resident_bytes_ = converted_.size() * sizeof(float);
+  memory_description_ =
+      std::format("embedded {}, decoded to {}", FormatBytes(resource_size),
+                  FormatBytes(resident_bytes_));
+  valid_ = true;
+}
+#endif
+
+WaveFile::WaveFile(const EmbeddedSound& sound, ma_engine* engine) {
+  valid_ = false;
+
+  if (const auto result =
+          InitConverted(engine, sound.samples, sound.frame_count,
+                        sound.channels, sound.sample_rate);
+      result != MA_SUCCESS) {
+    error_message_ = std::format("Internal error, failed to init sound: {}",
+                                 error::humanize_ma_result(result));
+    logging::MiniAudioError(result, "Failed to init sound");
+    return;
+  }
+
+  if (converted_.empty()) {
+    resident_bytes_ = sound.frame_count * sound.channels * sizeof(float);
+    memory_description_ =
+        std::format("embedded f32, {}", FormatBytes(resident_bytes_));
+  } else {
+    resident_bytes_ = converted_.size() * sizeof(float);
+    memory_description_ =
+        std::format("embedded f32, converted to {}",
+                    FormatBytes(resident_bytes_));
+  }
+  valid_ = true;
+}
+
+WaveFile::~WaveFile() {
+  logging::Debug("destroying wave file");
+  valid_ = false;
+  DestroyVoices();
+}
+
+void WaveFile::Play(const float gain) {
+  if (!valid_) {
+    logging::Debug("wave file is not valid, not playing");
+    return;
+  }
+  const auto index = pool_.Acquire([this](const size_t i) {
+    return ma_sound_is_playing(&voices_[i]->sound) == MA_TRUE;
+  });
+  auto& voice = *voices_[index];
+  if (!ma_sound_get_engine(&voice.sound)) return;
+  // restarts a stolen voice, and rewinds one that played to the end, past
+  // any silence at the start
+  ma_sound_seek_to_pcm_frame(&voice.sound, start_frame_);
+  // voices are shared by every event playing this sound, each at its own gain
+  ma_sound_set_volume(&voice.sound, gain);
+  voice.triggered_at.store(TriggerLatency::Now(), std::memory_order_relaxed);
+  if (const auto result = ma_sound_start(&voice.sound); result != MA_SUCCESS) {
+    logging::Debug("failed to play wave file");
+    logging::MiniAudioError(result, "Failed to play sound");
+  }
+}
+
+bool WaveFile::IsValid() const { return valid_; }
+
+std::string WaveFile::ErrorMessage() const { return error_message_; }
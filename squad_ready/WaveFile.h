@@ -0,0 +1,113 @@
+#pragma once
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "EmbeddedSound.h"
+#include "core/PcmAnalysis.h"
+#include "core/PcmCache.h"
+#include "core/VoicePool.h"
+#include "miniaudio/extras/miniaudio_split/miniaudio.h"
+
+// "1.5 MB" or "640 KB", for display.
+std::string FormatBytes(uint64_t bytes);
+
+class WaveFile {
+ public:
+  // Voices per sound, so a nag can overlap the alert still playing.
+  static constexpr size_t kMaxVoices = 4;
+
+  // One playable instance of the sound with its own read position. All
+  // voices of a sound share the same decoded samples where there are any.
+  struct Voice {
+    // must come first, miniaudio reads the voice through it
+    ma_data_source_base base;
+    // the source below that the voice forwards reads to
+    ma_data_source* inner = nullptr;
+    std::unique_ptr<ma_audio_buffer> buffer;
+    std::unique_ptr<ma_resource_manager_data_source> resource;
+    ma_sound sound;
+    bool source_initialized = false;
+    bool sound_initialized = false;
+    // when Play last started the voice, 0 once the audio thread has read it
+    std::atomic<int64_t> triggered_at = 0;
+    TriggerLatency* latency = nullptr;
+  };
+
+  WaveFile();
+  // A sound that failed to load before it got this far, for error_message.
+  explicit WaveFile(std::string error_message);
+  // Decoded sounds go through cache when given one.
+  WaveFile(const std::string& file_name, ma_engine* engine,
+           PcmCache* cache = nullptr);
+#ifdef _WIN32
+  // A WAVE resource of the DLL, decoded.
+  WaveFile(LPWSTR resource, ma_engine* engine);
+#endif
+  // Plays the samples in place, nothing is copied or decoded.
+  WaveFile(const EmbeddedSound& sound, ma_engine* engine);
+  WaveFile(const WaveFile&) = delete;
+  WaveFile& operator=(const WaveFile&) = delete;
+  ~WaveFile();
+  // Starts an idle voice at gain, or restarts the oldest if all are playing,
+  // from the first sound past any leading silence. Allocates nothing.
+  void Play(float gain);
+  bool IsValid() const;
+  std::string ErrorMessage() const;
+  // Approximate memory held by the loaded sound.
+  uint64_t ResidentBytes() const { return resident_bytes_; }
+  // How the sound is held and how much memory that takes, for display.
+  const std::string& MemoryDescription() const { return memory_description_; }
+  size_t Voices() const { return pool_.Voices(); }
+  uint64_t Steals() const { return pool_.Steals(); }
+  TriggerLatency::Stats Latency() const { return latency_.Get(); }
+  // Whether the levels below were measured, sounds that are streamed or
+  // decoded by the resource manager aren't.
+  bool Analyzed() const { return analyzed_; }
+  // Gain that evens the sound out to pcm_analysis::kTargetLoudnessDb.
+  float NormalizationGain() const { return normalization_gain_; }
+  float TrimmedMilliseconds() const { return trimmed_milliseconds_; }
+
+ private:
+  // Creates count voices, init_source points each voice's inner at its own
+  // buffer or resource manager source.
+  ma_result InitVoices(ma_engine* engine, size_t count,
+                       const std::function<ma_result(Voice&)>& init_source);
+  // Also releases the cache mapping once no voice reads from it.
+  void DestroyVoices();
+  // Plays PCM mapped from the cache, false if it has to be decoded instead.
+  bool InitFromCache(const std::string& file_name, ma_engine* engine,
+                     PcmCache& cache);
+  // Plays samples from memory in the engine's format, converting them into
+  // converted_ first unless they already are. Also measures them.
+  ma_result InitConverted(ma_engine* engine, const float* samples,
+                          ma_uint64 frame_count, ma_uint32 channels,
+                          ma_uint32 sample_rate);
+  void ApplyAnalysis(const PcmAnalysis& analysis, uint32_t sample_rate);
+
+  std::array<std::unique_ptr<Voice>, kMaxVoices> voices_;
+  VoicePool<kMaxVoices> pool_;
+  TriggerLatency latency_;
+  // set when playing from the cache, must outlive the voices
+  std::optional<PcmCache::Entry> cached_;
+  // samples the voices read when they had to be decoded or converted
+  std::vector<float> converted_;
+  std::string error_message_ = "Unknown error";
+  uint64_t resident_bytes_ = 0;
+  std::string memory_description_;
+  // frame Play starts from, in the source's sample rate
+  uint64_t start_frame_ = 0;
+  float normalization_gain_ = 1.0f;
+  float trimmed_milliseconds_ = 0.0f;
+  bool analyzed_ = false;
+  bool valid_;
+};
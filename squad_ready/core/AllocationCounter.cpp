@@ -0,0 +1,24 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+#if _DEBUG || SQUAD_READY_COUNT_ALLOCATIONS
+namespace {
+thread_local uint64_t allocations = 0;
+}  // namespace
+
+// Only replaces the DLL's own operator new, arcdps and ImGui allocate through
+// their own allocators. The other forms of new and delete forward to these.
+void* operator new(const std::size_t size) {
+  allocations++;
+  if (void* memory = std::malloc(size == 0 ? 1 : size)) return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+uint64_t allocation_counter::ThisThread() { return allocations; }
+#else
+uint64_t allocation_counter::ThisThread() { return 0; }
+#endif
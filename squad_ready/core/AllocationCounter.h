@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts the heap allocations the plugin makes through operator new, per
+// thread. Only debug builds, and the unit tests through
+// SQUAD_READY_COUNT_ALLOCATIONS, replace operator new to count, release
+// builds always report zero.
+namespace allocation_counter {
+
+#if _DEBUG || SQUAD_READY_COUNT_ALLOCATIONS
+constexpr bool kEnabled = true;
+#else
+constexpr bool kEnabled = false;
+#endif
+
+// Allocations made by the calling thread so far.
+uint64_t ThisThread();
+
+}  // namespace allocation_counter
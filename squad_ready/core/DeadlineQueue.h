@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+
+// One pending deadline per timer id, with the earliest cached so "is anything
+// due?" is a single compare. Id is an enum whose values are 0..Count-1.
+template <typename Id, size_t Count>
+class DeadlineQueue {
+ public:
+  using Clock = std::chrono::steady_clock;
+  static constexpr Clock::time_point kNever = Clock::time_point::max();
+
+  // Replaces any pending deadline for the id.
+  void Schedule(const Id id, const Clock::time_point deadline) {
+    deadlines_[Index(id)] = deadline;
+    if (deadline < next_) next_ = deadline;
+  }
+  void Cancel(const Id id) {
+    const auto deadline = deadlines_[Index(id)];
+    deadlines_[Index(id)] = kNever;
+    if (deadline == next_) UpdateNext();
+  }
+  void Clear() {
+    deadlines_.fill(kNever);
+    next_ = kNever;
+  }
+
+  bool Scheduled(const Id id) const { return deadlines_[Index(id)] != kNever; }
+  // kNever if not scheduled.
+  Clock::time_point Deadline(const Id id) const {
+    return deadlines_[Index(id)];
+  }
+  // kNever if nothing is scheduled.
+  Clock::time_point NextDeadline() const { return next_; }
+
+  // Calls f(id) for every deadline at or before now, earliest first. Each is
+  // unscheduled before f runs, so f may schedule it again. The due set is
+  // taken once up front, so one rescheduled at or before now runs on the next
+  // call rather than looping here.
+  template <typename F>
+  void RunDue(const Clock::time_point now, F&& f) {
+    if (next_ > now) return;
+    std::array<std::pair<Clock::time_point, size_t>, Count> due;
+    size_t due_count = 0;
+    for (size_t i = 0; i < Count; i++) {
+      if (deadlines_[i] > now) continue;
+      due[due_count++] = {deadlines_[i], i};
+      deadlines_[i] = kNever;
+    }
+    UpdateNext();
+    std::sort(due.begin(), due.begin() + due_count);
+    for (size_t i = 0; i < due_count; i++) f(static_cast<Id>(due[i].second));
+  }
+
+ private:
+  static size_t Index(const Id id) { return static_cast<size_t>(id); }
+
+  void UpdateNext() {
+    next_ = kNever;
+    for (const auto deadline : deadlines_) {
+      if (deadline < next_) next_ = deadline;
+    }
+  }
+
+  static std::array<Clock::time_point, Count> MakeEmpty() {
+    std::array<Clock::time_point, Count> deadlines;
+    deadlines.fill(kNever);
+    return deadlines;
+  }
+
+  std::array<Clock::time_point, Count> deadlines_ = MakeEmpty();
+  Clock::time_point next_ = kNever;
+};
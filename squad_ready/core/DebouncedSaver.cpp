@@ -0,0 +1,43 @@
+#include "DebouncedSaver.h"
+
+#include <utility>
+
+DebouncedSaver::DebouncedSaver(const Clock::duration delay,
+                               std::function<void()> save)
+    : delay_(delay), save_(std::move(save)), thread_([this] { Run(); }) {}
+
+void DebouncedSaver::Changed() {
+  {
+    std::lock_guard lock(mutex_);
+    pending_ = true;
+    due_ = Clock::now() + delay_;
+  }
+  changed_.notify_one();
+}
+
+void DebouncedSaver::Stop() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  changed_.notify_one();
+  if (thread_.joinable()) thread_.join();
+}
+
+void DebouncedSaver::Run() {
+  std::unique_lock lock(mutex_);
+  while (true) {
+    changed_.wait(lock, [this] { return pending_ || stopping_; });
+    // every change pushes due_ back
+    while (pending_ && !stopping_ && Clock::now() < due_) {
+      changed_.wait_until(lock, due_);
+    }
+    if (pending_) {
+      pending_ = false;
+      lock.unlock();
+      save_();
+      lock.lock();
+    }
+    if (stopping_) return;
+  }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Runs save on a background thread once changes have stopped for a while, so
+// a burst of changes, like dragging a slider, is saved once. Changed only
+// takes a lock the thread never holds while saving, so it never waits on the
+// save itself.
+class DebouncedSaver {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  DebouncedSaver(Clock::duration delay, std::function<void()> save);
+  DebouncedSaver(const DebouncedSaver&) = delete;
+  DebouncedSaver& operator=(const DebouncedSaver&) = delete;
+  ~DebouncedSaver() { Stop(); }
+
+  // Any thread. Saves delay after the last call.
+  void Changed();
+  // Saves right away if a save is pending and stops the thread. Blocks until
+  // it is done.
+  void Stop();
+
+ private:
+  void Run();
+
+  Clock::duration delay_;
+  std::function<void()> save_;
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  bool pending_ = false;
+  bool stopping_ = false;
+  Clock::time_point due_;
+  std::thread thread_;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+// Binary encoding of log message arguments, so a message can be queued as a
+// few copied bytes and formatted later on another thread. Numbers and
+// pointers are stored as is, strings as a 16-bit length and their
+// characters, cut short when the record is full. Decoding gives strings back
+// as views into the record.
+namespace log_args {
+
+template <typename T>
+constexpr bool kIsString =
+    std::is_convertible_v<const T&, std::string_view> &&
+    !std::is_same_v<T, std::nullptr_t>;
+
+template <typename T>
+constexpr bool kIsPointer =
+    (std::is_pointer_v<T> && !kIsString<T>) ||
+    std::is_same_v<T, std::nullptr_t>;
+
+// What an argument of type T decodes to.
+template <typename T>
+using Decoded = std::conditional_t<
+    kIsString<T>, std::string_view,
+    std::conditional_t<kIsPointer<T>, const void*, T>>;
+
+template <typename T>
+constexpr bool kEncodable =
+    kIsString<T> || kIsPointer<T> || std::is_arithmetic_v<T>;
+
+// Bytes taken by the arguments besides the characters of their strings.
+template <typename... Args>
+constexpr size_t kFixedSize =
+    (0 + ... + (kIsString<Args> ? sizeof(uint16_t) : sizeof(Decoded<Args>)));
+
+namespace detail {
+
+template <typename T>
+std::string_view AsString(const T& value) {
+  if constexpr (std::is_pointer_v<T>) {
+    if (value == nullptr) return {};
+  }
+  return std::string_view(value);
+}
+
+template <typename T>
+void Write(std::byte*& out, const T& value) {
+  std::memcpy(out, &value, sizeof(value));
+  out += sizeof(value);
+}
+
+template <typename T>
+void WriteArg(std::byte*& out, size_t& string_space, const T& value,
+              bool& truncated) {
+  if constexpr (kIsString<T>) {
+    const auto string = AsString(value);
+    const auto size = static_cast<uint16_t>(
+        std::min({string.size(), string_space, size_t{0xFFFF}}));
+    truncated |= size < string.size();
+    Write(out, size);
+    std::memcpy(out, string.data(), size);
+    out += size;
+    string_space -= size;
+  } else {
+    Write(out, static_cast<Decoded<T>>(value));
+  }
+}
+
+template <typename T>
+Decoded<T> ReadArg(const std::byte*& in) {
+  if constexpr (kIsString<T>) {
+    uint16_t size;
+    std::memcpy(&size, in, sizeof(size));
+    in += sizeof(size);
+    const std::string_view string(reinterpret_cast<const char*>(in), size);
+    in += size;
+    return string;
+  } else {
+    Decoded<T> value;
+    std::memcpy(&value, in, sizeof(value));
+    in += sizeof(value);
+    return value;
+  }
+}
+
+}  // namespace detail
+
+// Writes args to out, which holds capacity bytes, and returns the bytes
+// written. Sets truncated if a string didn't fit whole.
+template <typename... Args>
+size_t Encode(std::byte* out, const size_t capacity, bool& truncated,
+              const Args&... args) {
+  static_assert((kEncodable<Args> && ...),
+                "log arguments must be numbers, pointers or strings");
+  const auto begin = out;
+  size_t string_space = capacity - kFixedSize<Args...>;
+  truncated = false;
+  (detail::WriteArg(out, string_space, args, truncated), ...);
+  return static_cast<size_t>(out - begin);
+}
+
+// Reads back what Encode<Args...> wrote.
+template <typename... Args>
+std::tuple<Decoded<Args>...> Decode(const std::byte* in) {
+  // braced initialization reads the arguments in order
+  return std::tuple<Decoded<Args>...>{detail::ReadArg<Args>(in)...};
+}
+
+}  // namespace log_args
@@ -0,0 +1,68 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+std::unique_ptr<MappedFile> MappedFile::Open(
+    const std::filesystem::path& path) {
+  std::unique_ptr<MappedFile> mapped(new MappedFile());
+  const HANDLE file =
+      CreateFileW(path.c_str(), GENERIC_READ,
+                  FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                  FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return nullptr;
+  mapped->file_ = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return nullptr;
+  mapped->size_ = static_cast<size_t>(size.QuadPart);
+
+  mapped->mapping_ =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapped->mapping_ == nullptr) return nullptr;
+
+  mapped->data_ = static_cast<const uint8_t*>(
+      MapViewOfFile(mapped->mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (mapped->data_ == nullptr) return nullptr;
+  return mapped;
+}
+
+MappedFile::~MappedFile() {
+  if (data_) UnmapViewOfFile(data_);
+  if (mapping_) CloseHandle(mapping_);
+  if (file_) CloseHandle(file_);
+}
+
+#else
+
+std::unique_ptr<MappedFile> MappedFile::Open(
+    const std::filesystem::path& path) {
+  std::unique_ptr<MappedFile> mapped(new MappedFile());
+  mapped->fd_ = open(path.c_str(), O_RDONLY);
+  if (mapped->fd_ < 0) return nullptr;
+
+  struct stat status;
+  if (fstat(mapped->fd_, &status) != 0 || status.st_size == 0) return nullptr;
+  mapped->size_ = static_cast<size_t>(status.st_size);
+
+  void* data =
+      mmap(nullptr, mapped->size_, PROT_READ, MAP_SHARED, mapped->fd_, 0);
+  if (data == MAP_FAILED) return nullptr;
+  mapped->data_ = static_cast<const uint8_t*>(data);
+  return mapped;
+}
+
+MappedFile::~MappedFile() {
+  if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+  if (fd_ >= 0) close(fd_);
+}
+
+#endif
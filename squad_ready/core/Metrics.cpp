@@ -0,0 +1,169 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace {
+
+uint32_t ThreadNumber() {
+  static std::atomic<uint32_t> next{1};
+  thread_local const uint32_t number =
+      next.fetch_add(1, std::memory_order_relaxed);
+  return number;
+}
+
+uint64_t Nanoseconds(const Metrics::Clock::duration duration) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+}  // namespace
+
+const char* MetricName(const Metric metric) {
+  switch (metric) {
+    case Metric::WindowMessage:
+      return "window message";
+    case Metric::Frame:
+      return "frame";
+    case Metric::SquadUpdate:
+      return "squad update";
+    case Metric::SquadTick:
+      return "squad tick";
+    case Metric::DebugWindow:
+      return "debug window";
+    case Metric::OptionsPanel:
+      return "options panel";
+    case Metric::SoundLoad:
+      return "sound load";
+    case Metric::SoundPlay:
+      return "sound play";
+    case Metric::UsersUpdated:
+      return "users updated";
+    default:
+      return "unknown";
+  }
+}
+
+bool IsTimer(const Metric metric) { return metric < Metric::UsersUpdated; }
+
+void Metrics::AddTime(const Metric metric, const Clock::time_point start,
+                      const Clock::time_point end) {
+  const auto duration = Nanoseconds(end - start);
+  auto& accumulator = current_[static_cast<size_t>(metric)];
+  accumulator.count.fetch_add(1, std::memory_order_relaxed);
+  accumulator.total.fetch_add(duration, std::memory_order_relaxed);
+  auto max_call = accumulator.max_call.load(std::memory_order_relaxed);
+  while (duration > max_call &&
+         !accumulator.max_call.compare_exchange_weak(
+             max_call, duration, std::memory_order_relaxed)) {
+  }
+  if (capturing_.load(std::memory_order_acquire)) {
+    Capture(metric, start, duration);
+  }
+}
+
+void Metrics::Add(const Metric metric, const uint64_t value) {
+  auto& accumulator = current_[static_cast<size_t>(metric)];
+  accumulator.count.fetch_add(1, std::memory_order_relaxed);
+  accumulator.total.fetch_add(value, std::memory_order_relaxed);
+  if (capturing_.load(std::memory_order_acquire)) {
+    Capture(metric, Clock::now(), value);
+  }
+}
+
+void Metrics::Capture(const Metric metric, const Clock::time_point start,
+                      const uint64_t value) {
+  const size_t index = capture_next_.fetch_add(1, std::memory_order_relaxed);
+  if (index >= kCaptureEvents) {
+    capturing_.store(false, std::memory_order_relaxed);
+    return;
+  }
+  auto& event = events_[index];
+  event.metric = metric;
+  event.thread = ThreadNumber();
+  event.start = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    start - capture_start_)
+                    .count();
+  event.value = value;
+  event.written.store(true, std::memory_order_release);
+}
+
+void Metrics::EndFrame() {
+  auto& frame = frames_[next_frame_];
+  for (size_t i = 0; i < kMetrics; i++) {
+    frame[i].count = current_[i].count.exchange(0, std::memory_order_relaxed);
+    frame[i].total = current_[i].total.exchange(0, std::memory_order_relaxed);
+  }
+  next_frame_ = (next_frame_ + 1) % kFrames;
+  frames_kept_ = std::min(frames_kept_ + 1, kFrames);
+}
+
+Metrics::Summary Metrics::Summarize(const Metric metric) const {
+  const auto index = static_cast<size_t>(metric);
+  Summary summary;
+  summary.max_call =
+      current_[index].max_call.load(std::memory_order_relaxed);
+  if (frames_kept_ == 0) return summary;
+
+  const auto& last = frames_[(next_frame_ + kFrames - 1) % kFrames][index];
+  summary.last_count = last.count;
+  summary.last_total = last.total;
+  uint64_t count = 0;
+  uint64_t total = 0;
+  // frames past frames_kept_ are still zero
+  for (const auto& frame : frames_) {
+    count += frame[index].count;
+    total += frame[index].total;
+    summary.max_total = std::max(summary.max_total, frame[index].total);
+  }
+  summary.average_count = static_cast<double>(count) / frames_kept_;
+  summary.average_total = static_cast<double>(total) / frames_kept_;
+  return summary;
+}
+
+void Metrics::StartCapture() {
+  capturing_.store(false, std::memory_order_relaxed);
+  for (auto& event : events_) {
+    event.written.store(false, std::memory_order_relaxed);
+  }
+  capture_next_.store(0, std::memory_order_relaxed);
+  capture_start_ = Clock::now();
+  capturing_.store(true, std::memory_order_release);
+}
+
+void Metrics::StopCapture() {
+  capturing_.store(false, std::memory_order_relaxed);
+}
+
+size_t Metrics::CapturedEvents() const {
+  return std::min(capture_next_.load(std::memory_order_relaxed),
+                  kCaptureEvents);
+}
+
+bool Metrics::WriteChromeTrace(const std::string& path) const {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file.is_open()) return false;
+
+  // trace event format, timestamps in microseconds
+  file << std::fixed << std::setprecision(3);
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (size_t i = 0; i < CapturedEvents(); i++) {
+    const auto& event = events_[i];
+    // a call still being recorded when the capture stopped
+    if (!event.written.load(std::memory_order_acquire)) continue;
+    file << (first ? "\n" : ",\n");
+    first = false;
+    file << "{\"name\":\"" << MetricName(event.metric)
+         << "\",\"cat\":\"squad_ready\",\"pid\":1,\"tid\":" << event.thread
+         << ",\"ts\":" << event.start / 1000.0;
+    if (IsTimer(event.metric)) {
+      file << ",\"ph\":\"X\",\"dur\":" << event.value / 1000.0 << "}";
+    } else {
+      file << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+    }
+  }
+  file << "\n]}\n";
+  return file.good();
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class Metric : uint8_t {
+  // timers
+  WindowMessage,
+  Frame,
+  SquadUpdate,
+  SquadTick,
+  DebugWindow,
+  OptionsPanel,
+  SoundLoad,
+  SoundPlay,
+  // counters
+  UsersUpdated,
+  Count,
+};
+
+const char* MetricName(Metric metric);
+// Timers record how long a call took, counters only add up values.
+bool IsTimer(Metric metric);
+
+// What the plugin costs per frame. Timers and counters can be recorded from
+// any thread for a few relaxed atomic operations and are rolled up per frame
+// by EndFrame, keeping the last kFrames frames. On demand, individual calls
+// are also captured into a fixed size buffer and written out as a Chrome
+// trace (chrome://tracing, ui.perfetto.dev).
+class Metrics {
+ public:
+  using Clock = std::chrono::steady_clock;
+  static constexpr size_t kMetrics = static_cast<size_t>(Metric::Count);
+  static constexpr size_t kFrames = 128;
+  static constexpr size_t kCaptureEvents = 8192;
+
+  // Rollup of one metric over the kept frames, times in nanoseconds.
+  struct Summary {
+    uint64_t last_count = 0;
+    uint64_t last_total = 0;
+    double average_count = 0;
+    double average_total = 0;
+    uint64_t max_total = 0;
+    // longest single call ever, timers only
+    uint64_t max_call = 0;
+  };
+
+  Metrics() = default;
+  Metrics(const Metrics&) = delete;
+  Metrics& operator=(const Metrics&) = delete;
+
+  // Any thread.
+  void AddTime(Metric metric, Clock::time_point start, Clock::time_point end);
+  void Add(Metric metric, uint64_t value = 1);
+
+  // UI thread, once at the start of every frame.
+  void EndFrame();
+  // UI thread.
+  Summary Summarize(Metric metric) const;
+  size_t FramesKept() const { return frames_kept_; }
+
+  // UI thread. Capturing stops by itself once the buffer is full.
+  void StartCapture();
+  void StopCapture();
+  bool Capturing() const {
+    return capturing_.load(std::memory_order_relaxed);
+  }
+  size_t CapturedEvents() const;
+  // UI thread, after StopCapture.
+  bool WriteChromeTrace(const std::string& path) const;
+
+ private:
+  struct Accumulator {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> max_call{0};
+  };
+  struct Frame {
+    uint64_t count = 0;
+    uint64_t total = 0;
+  };
+  struct Event {
+    // set once the rest is written
+    std::atomic<bool> written{false};
+    Metric metric = Metric::Count;
+    uint32_t thread = 0;
+    // nanoseconds since the capture started
+    int64_t start = 0;
+    // nanoseconds for timers, the value added for counters
+    uint64_t value = 0;
+  };
+
+  void Capture(Metric metric, Clock::time_point start, uint64_t value);
+
+  std::array<Accumulator, kMetrics> current_;
+  std::array<std::array<Frame, kMetrics>, kFrames> frames_{};
+  size_t next_frame_ = 0;
+  size_t frames_kept_ = 0;
+
+  std::atomic<bool> capturing_ = false;
+  Clock::time_point capture_start_;
+  std::atomic<size_t> capture_next_ = 0;
+  std::array<Event, kCaptureEvents> events_;
+};
+
+// Records the time from construction to destruction as metric.
+class ScopedTimer {
+ public:
+  ScopedTimer(Metrics& metrics, const Metric metric)
+      : metrics_(metrics), metric_(metric), start_(Metrics::Clock::now()) {}
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+  ~ScopedTimer() { metrics_.AddTime(metric_, start_, Metrics::Clock::now()); }
+
+ private:
+  Metrics& metrics_;
+  Metric metric_;
+  Metrics::Clock::time_point start_;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free multi-producer/single-consumer ring buffer. Any number of
+// threads may push and one thread may pop, neither ever blocks: producers
+// claim a slot with a compare-and-swap and publish it through the slot's
+// sequence number, so a full queue fails the push instead of waiting.
+template <typename T, size_t Capacity>
+class MpscQueue {
+  static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                "capacity must be a power of 2");
+
+ public:
+  MpscQueue() {
+    for (size_t i = 0; i < Capacity; i++) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // Any thread. fill(T&) writes the element in place, only once a slot is
+  // claimed.
+  template <typename F>
+  bool TryPushWith(F&& fill) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &slots_[tail & (Capacity - 1)];
+      const auto lag = static_cast<std::ptrdiff_t>(
+          slot->sequence.load(std::memory_order_acquire) - tail);
+      if (lag == 0) {
+        if (tail_.compare_exchange_weak(tail, tail + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (lag < 0) {
+        // the consumer hasn't popped this slot since the last lap
+        return false;
+      } else {
+        tail = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    fill(slot->value);
+    slot->sequence.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Any thread.
+  bool TryPush(const T& value) {
+    return TryPushWith([&](T& slot) { slot = value; });
+  }
+
+  // Consumer only. Returns the oldest element without popping it, or nullptr
+  // if it isn't published yet.
+  T* Front() {
+    Slot& slot = slots_[head_ & (Capacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+      return nullptr;
+    }
+    return &slot.value;
+  }
+
+  // Consumer only, after Front returned an element.
+  void Pop() {
+    slots_[head_ & (Capacity - 1)].sequence.store(head_ + Capacity,
+                                                  std::memory_order_release);
+    head_++;
+  }
+
+  // Consumer only.
+  bool Empty() { return Front() == nullptr; }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  // keep the indices on separate cache lines so the threads don't false share
+  alignas(64) std::atomic<size_t> tail_{0};
+  alignas(64) size_t head_ = 0;
+  alignas(64) std::array<Slot, Capacity> slots_;
+};
@@ -0,0 +1,114 @@
+#include "OfflineOutput.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr std::chrono::nanoseconds::rep kNanosecondsPerSecond = 1000000000;
+constexpr uint16_t kWaveFormatIeeeFloat = 3;
+constexpr uint32_t kHeaderBytes = 44;
+
+void PutU16(uint8_t* out, const uint16_t value) {
+  out[0] = static_cast<uint8_t>(value);
+  out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void PutU32(uint8_t* out, const uint32_t value) {
+  PutU16(out, static_cast<uint16_t>(value));
+  PutU16(out + 2, static_cast<uint16_t>(value >> 16));
+}
+
+// A canonical 44 byte WAV header for data_bytes of f32 samples.
+void WriteHeader(std::FILE* file, const uint32_t channels,
+                 const uint32_t sample_rate, const uint32_t data_bytes) {
+  uint8_t header[kHeaderBytes];
+  std::memcpy(header, "RIFF", 4);
+  PutU32(header + 4, kHeaderBytes - 8 + data_bytes);
+  std::memcpy(header + 8, "WAVEfmt ", 8);
+  PutU32(header + 16, 16);
+  PutU16(header + 20, kWaveFormatIeeeFloat);
+  PutU16(header + 22, static_cast<uint16_t>(channels));
+  PutU32(header + 24, sample_rate);
+  PutU32(header + 28, sample_rate * channels * sizeof(float));
+  PutU16(header + 32, static_cast<uint16_t>(channels * sizeof(float)));
+  PutU16(header + 34, 32);
+  std::memcpy(header + 36, "data", 4);
+  PutU32(header + 40, data_bytes);
+  std::fwrite(header, 1, sizeof(header), file);
+}
+
+}  // namespace
+
+OfflineOutput::OfflineOutput(const uint32_t channels,
+                             const uint32_t sample_rate, Render render)
+    : channels_(channels),
+      sample_rate_(sample_rate),
+      render_(std::move(render)),
+      block_(static_cast<size_t>(kBlockFrames) * channels) {}
+
+OfflineOutput::~OfflineOutput() { CloseFile(); }
+
+bool OfflineOutput::OpenFile(const std::filesystem::path& path) {
+  CloseFile();
+#ifdef _WIN32
+  file_ = _wfopen(path.c_str(), L"wb");
+#else
+  file_ = std::fopen(path.c_str(), "wb");
+#endif
+  if (!file_) return false;
+  file_frames_ = 0;
+  // sizes are filled in by FinishFile
+  WriteHeader(file_, channels_, sample_rate_, 0);
+  return true;
+}
+
+void OfflineOutput::CloseFile() {
+  if (!file_) return;
+  FinishFile();
+  std::fclose(file_);
+  file_ = nullptr;
+}
+
+void OfflineOutput::Advance(const std::chrono::nanoseconds duration) {
+  pending_ += duration.count() * sample_rate_;
+  auto frames = static_cast<uint64_t>(pending_ / kNanosecondsPerSecond);
+  pending_ %= kNanosecondsPerSecond;
+  while (frames > 0) {
+    const auto block = static_cast<uint32_t>(
+        std::min<uint64_t>(frames, kBlockFrames));
+    RenderBlock(block);
+    frames -= block;
+  }
+}
+
+std::chrono::nanoseconds OfflineOutput::Time() const {
+  return std::chrono::nanoseconds(
+      static_cast<std::chrono::nanoseconds::rep>(
+          frames_rendered_ * kNanosecondsPerSecond / sample_rate_));
+}
+
+void OfflineOutput::RenderBlock(const uint32_t frame_count) {
+  const size_t samples = static_cast<size_t>(frame_count) * channels_;
+  // the render callback mixes into silence, like a pre-silenced device buffer
+  std::fill_n(block_.begin(), samples, 0.0f);
+  render_(block_.data(), frame_count);
+  for (size_t i = 0; i < samples; i++) {
+    peak_ = std::max(peak_, std::abs(block_[i]));
+  }
+  if (file_) {
+    std::fwrite(block_.data(), sizeof(float), samples, file_);
+    file_frames_ += frame_count;
+  }
+  frames_rendered_ += frame_count;
+}
+
+void OfflineOutput::FinishFile() {
+  const auto data_bytes = file_frames_ * channels_ * sizeof(float);
+  std::fseek(file_, 0, SEEK_SET);
+  // a WAV file can't describe more than 4GB, clamp rather than wrap
+  WriteHeader(file_, channels_, sample_rate_,
+              static_cast<uint32_t>(std::min<uint64_t>(
+                  data_bytes, UINT32_MAX - kHeaderBytes)));
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+// Stands in for a sound card when there isn't one. Audio is pulled on a
+// virtual clock: each Advance renders exactly the frames that much time is
+// worth, in fixed size blocks like a device period, and either drops them or
+// appends them to a 32-bit float WAV file. Whoever owns the clock decides how
+// fast time passes, so a headless run can be deterministic and as fast as the
+// mixer allows.
+class OfflineOutput {
+ public:
+  // Fills frame_count interleaved frames, like a device data callback.
+  using Render = std::function<void(float* frames, uint32_t frame_count)>;
+
+  // 10ms at 48kHz
+  static constexpr uint32_t kBlockFrames = 480;
+
+  OfflineOutput(uint32_t channels, uint32_t sample_rate, Render render);
+  OfflineOutput(const OfflineOutput&) = delete;
+  OfflineOutput& operator=(const OfflineOutput&) = delete;
+  // Finishes the WAV file if there is one.
+  ~OfflineOutput();
+
+  // Appends everything rendered from now on to a new WAV file at path.
+  bool OpenFile(const std::filesystem::path& path);
+  void CloseFile();
+
+  // Renders duration worth of frames. Partial frames carry over, so many
+  // small steps render the same frames as one large one.
+  void Advance(std::chrono::nanoseconds duration);
+
+  uint32_t Channels() const { return channels_; }
+  uint32_t SampleRate() const { return sample_rate_; }
+  uint64_t FramesRendered() const { return frames_rendered_; }
+  // Virtual time of the last rendered frame.
+  std::chrono::nanoseconds Time() const;
+  // Loudest absolute sample since the last ResetPeak, 1.0 is full scale.
+  float Peak() const { return peak_; }
+  void ResetPeak() { peak_ = 0.0f; }
+
+ private:
+  void RenderBlock(uint32_t frame_count);
+  void FinishFile();
+
+  uint32_t channels_;
+  uint32_t sample_rate_;
+  Render render_;
+  std::vector<float> block_;
+  // time not yet rendered as nanoseconds times the sample rate, so whole
+  // frames are pending_ / 1e9
+  std::chrono::nanoseconds::rep pending_ = 0;
+  uint64_t frames_rendered_ = 0;
+  float peak_ = 0.0f;
+  std::FILE* file_ = nullptr;
+  uint64_t file_frames_ = 0;
+};
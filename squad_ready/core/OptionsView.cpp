@@ -0,0 +1,42 @@
+#include "OptionsView.h"
+
+void PathEdit::Sync(const std::optional<std::string>& path) {
+  static const std::string kNoPath;
+  // compared first, assigning even the same path may allocate
+  if (const auto& current = path ? *path : kNoPath;
+      !active && buffer != current) {
+    buffer = current;
+  }
+}
+
+bool OptionsView::OutOfDate(const uint64_t settings_version,
+                            const uint64_t audio_version) const {
+  return !built || this->settings_version != settings_version ||
+         this->audio_version != audio_version;
+}
+
+void OptionsView::Rebuild(const uint64_t settings_version,
+                          const uint64_t audio_version,
+                          const std::optional<std::string>& output_device,
+                          AudioStatusSource& audio) {
+  this->settings_version = settings_version;
+  this->audio_version = audio_version;
+  built = true;
+
+  for (size_t i = 0; i < kSoundEvents; i++) {
+    const auto event = static_cast<SoundEvent>(i);
+    auto& sound = sounds[i];
+    sound.error = audio.SoundStatus(event);
+    sound.details.clear();
+    if (!sound.error.empty()) continue;
+    if (const auto memory = audio.SoundMemory(event); !memory.empty()) {
+      const auto levels = audio.SoundLevels(event);
+      sound.details = "(" + memory;
+      if (!levels.empty()) sound.details += ", " + levels;
+      sound.details += ")";
+    }
+  }
+  devices = audio.OutputDevices();
+  current_device = audio.OutputDeviceName();
+  selected_device = output_device.value_or("Default");
+}
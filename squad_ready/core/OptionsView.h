@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "SoundEvent.h"
+
+// What the options panel asks the audio player about its sounds and output.
+// The plugin's AudioPlayer implements it, tests with fakes.
+class AudioStatusSource {
+ public:
+  virtual ~AudioStatusSource() = default;
+  // Why the event's sound failed to load, empty if it didn't.
+  virtual std::string SoundStatus(SoundEvent event) = 0;
+  virtual std::string SoundMemory(SoundEvent event) = 0;
+  // Silence trimmed and loudness gain, empty if the sound wasn't analyzed.
+  virtual std::string SoundLevels(SoundEvent event) = 0;
+  virtual std::vector<std::string> OutputDevices() = 0;
+  virtual std::string OutputDeviceName() = 0;
+};
+
+// Edit buffer of a path text field. Edits go to the buffer and are only
+// committed to the settings once the field loses focus, so the sound is
+// reloaded once per edit instead of once per keystroke.
+struct PathEdit {
+  // Takes the path from the settings unless the field is being edited.
+  void Sync(const std::optional<std::string>& path);
+
+  std::string buffer;
+  bool active = false;
+};
+
+// Everything the options panel shows that has to be asked from the audio
+// player or built as a string. Rebuilt only when the settings or the audio
+// change, so drawing an unchanged panel doesn't allocate.
+struct OptionsView {
+  struct Sound {
+    // why the sound failed to load, empty if it didn't
+    std::string error;
+    // "(memory, levels)" of a loaded sound
+    std::string details;
+  };
+
+  // The versions differ from the ones the view was built from.
+  bool OutOfDate(uint64_t settings_version, uint64_t audio_version) const;
+  // Rebuilds from audio and the output device picked in the settings.
+  void Rebuild(uint64_t settings_version, uint64_t audio_version,
+               const std::optional<std::string>& output_device,
+               AudioStatusSource& audio);
+
+  const Sound& Of(SoundEvent event) const {
+    return sounds[static_cast<size_t>(event)];
+  }
+
+  std::array<Sound, kSoundEvents> sounds;
+  std::vector<std::string> devices;
+  // the output device picked in the settings
+  std::string selected_device;
+  std::string current_device;
+  uint64_t settings_version = 0;
+  uint64_t audio_version = 0;
+  bool built = false;
+};
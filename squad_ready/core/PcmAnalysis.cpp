@@ -0,0 +1,166 @@
+#include "PcmAnalysis.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SQUAD_READY_PCM_SSE2
+#endif
+
+namespace {
+
+// What one pass over a run of samples found.
+struct BlockLevels {
+  float peak = 0.0f;
+  double sum_of_squares = 0.0;
+  // index of the first sample above the threshold, count if none
+  uint64_t first_sound = 0;
+};
+
+BlockLevels ScanScalar(const float* samples, const uint64_t count,
+                       const bool find_sound) {
+  BlockLevels levels;
+  levels.first_sound = count;
+  float sum = 0.0f;
+  for (uint64_t i = 0; i < count; i++) {
+    const float magnitude = std::abs(samples[i]);
+    levels.peak = std::max(levels.peak, magnitude);
+    sum += samples[i] * samples[i];
+    if (find_sound && levels.first_sound == count &&
+        magnitude > pcm_analysis::kSilenceThreshold) {
+      levels.first_sound = i;
+    }
+  }
+  levels.sum_of_squares = sum;
+  return levels;
+}
+
+#ifdef SQUAD_READY_PCM_SSE2
+
+BlockLevels Scan(const float* samples, const uint64_t count,
+                 bool find_sound) {
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 threshold = _mm_set1_ps(pcm_analysis::kSilenceThreshold);
+  __m128 peak = _mm_setzero_ps();
+  __m128 sum = _mm_setzero_ps();
+  BlockLevels levels;
+  levels.first_sound = count;
+
+  uint64_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 frame = _mm_loadu_ps(samples + i);
+    const __m128 magnitude = _mm_and_ps(frame, abs_mask);
+    peak = _mm_max_ps(peak, magnitude);
+    sum = _mm_add_ps(sum, _mm_mul_ps(frame, frame));
+    if (find_sound) {
+      const int loud = _mm_movemask_ps(_mm_cmpgt_ps(magnitude, threshold));
+      if (loud != 0) {
+        levels.first_sound = i + std::countr_zero(static_cast<unsigned>(loud));
+        find_sound = false;
+      }
+    }
+  }
+
+  float lanes[4];
+  _mm_storeu_ps(lanes, peak);
+  levels.peak = std::max({lanes[0], lanes[1], lanes[2], lanes[3]});
+  _mm_storeu_ps(lanes, sum);
+  levels.sum_of_squares =
+      static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+
+  const auto tail = ScanScalar(samples + i, count - i, find_sound);
+  levels.peak = std::max(levels.peak, tail.peak);
+  levels.sum_of_squares += tail.sum_of_squares;
+  if (find_sound && tail.first_sound != count - i) {
+    levels.first_sound = i + tail.first_sound;
+  }
+  return levels;
+}
+
+#else
+
+BlockLevels Scan(const float* samples, const uint64_t count,
+                 const bool find_sound) {
+  return ScanScalar(samples, count, find_sound);
+}
+
+#endif
+
+float ToDb(const double mean_square) {
+  if (mean_square <= 0.0) return -100.0f;
+  return static_cast<float>(10.0 * std::log10(mean_square));
+}
+
+}  // namespace
+
+namespace pcm_analysis {
+
+PcmAnalysis Analyze(const float* samples, const uint64_t frame_count,
+                    const uint32_t channels, const uint32_t sample_rate) {
+  PcmAnalysis analysis;
+  analysis.frame_count = frame_count;
+  analysis.first_sound_frame = frame_count;
+  if (frame_count == 0 || channels == 0) return analysis;
+
+  // the sum of squares is kept per block, both to gate the quiet ones and so
+  // float accumulation never runs over more than a block of samples
+  const uint64_t block_frames =
+      std::max<uint64_t>(1, uint64_t{sample_rate} * kBlockMilliseconds / 1000);
+  std::vector<double> block_mean_squares;
+  block_mean_squares.reserve(frame_count / block_frames + 1);
+  bool find_sound = true;
+  for (uint64_t start = 0; start < frame_count; start += block_frames) {
+    const uint64_t frames = std::min(block_frames, frame_count - start);
+    const uint64_t count = frames * channels;
+    const auto levels = Scan(samples + start * channels, count, find_sound);
+    analysis.peak = std::max(analysis.peak, levels.peak);
+    if (find_sound && levels.first_sound != count) {
+      analysis.first_sound_frame = start + levels.first_sound / channels;
+      find_sound = false;
+    }
+    block_mean_squares.push_back(levels.sum_of_squares /
+                                 static_cast<double>(count));
+  }
+
+  // absolute gate, then drop blocks well below the mean of what is left
+  const auto gated_mean = [&](const float gate_db) {
+    double total = 0.0;
+    size_t blocks = 0;
+    for (const auto mean_square : block_mean_squares) {
+      if (ToDb(mean_square) < gate_db) continue;
+      total += mean_square;
+      blocks++;
+    }
+    return blocks == 0 ? 0.0 : total / blocks;
+  };
+  const double absolute = gated_mean(kAbsoluteGateDb);
+  if (absolute <= 0.0) return analysis;
+  analysis.loudness_db = ToDb(gated_mean(ToDb(absolute) + kRelativeGateDb));
+  return analysis;
+}
+
+float NormalizationGain(const PcmAnalysis& analysis) {
+  if (analysis.peak <= 0.0f || analysis.loudness_db <= kAbsoluteGateDb) {
+    return 1.0f;
+  }
+  const float gain_db = std::min(kTargetLoudnessDb - analysis.loudness_db,
+                                 kMaxBoostDb);
+  // never push the peak past full scale
+  return std::min(std::pow(10.0f, gain_db / 20.0f), 1.0f / analysis.peak);
+}
+
+uint64_t TrimFrames(const PcmAnalysis& analysis, const uint32_t sample_rate) {
+  // a silent sound is left alone rather than trimmed to nothing
+  if (analysis.first_sound_frame >= analysis.frame_count) return 0;
+  const uint64_t lead_in = uint64_t{sample_rate} * kLeadInMilliseconds / 1000;
+  return analysis.first_sound_frame > lead_in
+             ? analysis.first_sound_frame - lead_in
+             : 0;
+}
+
+}  // namespace pcm_analysis
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+// Levels of a decoded sound, measured in one pass over its samples when it
+// is loaded, so alerts can skip leading silence and play at an even loudness
+// whatever file they come from.
+struct PcmAnalysis {
+  // largest absolute sample, 1.0 is full scale
+  float peak = 0.0f;
+  // gated mean square level in dBFS, like LUFS without the K-weighting
+  float loudness_db = -100.0f;
+  // first frame above the silence threshold, frame_count if there is none
+  uint64_t first_sound_frame = 0;
+  uint64_t frame_count = 0;
+};
+
+namespace pcm_analysis {
+
+// -60 dBFS, quieter than any speaker or headset reproduces usefully.
+constexpr float kSilenceThreshold = 0.001f;
+// Blocks below this don't count towards the loudness, as in BS.1770.
+constexpr float kAbsoluteGateDb = -70.0f;
+constexpr float kRelativeGateDb = -10.0f;
+constexpr uint32_t kBlockMilliseconds = 100;
+// Where NormalizationGain aims, the level of the bundled sounds.
+constexpr float kTargetLoudnessDb = -19.0f;
+// Quiet files are only boosted so far, to not turn noise into an alert.
+constexpr float kMaxBoostDb = 12.0f;
+// Left in front of the first sound so its attack isn't cut off.
+constexpr uint32_t kLeadInMilliseconds = 5;
+
+// frame_count frames of interleaved samples. Uses SSE2 where available.
+PcmAnalysis Analyze(const float* samples, uint64_t frame_count,
+                    uint32_t channels, uint32_t sample_rate);
+
+// Linear gain that brings the sound to kTargetLoudnessDb without clipping.
+float NormalizationGain(const PcmAnalysis& analysis);
+
+// Leading frames to skip.
+uint64_t TrimFrames(const PcmAnalysis& analysis, uint32_t sample_rate);
+
+}  // namespace pcm_analysis
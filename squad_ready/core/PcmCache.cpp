@@ -0,0 +1,228 @@
+#include "PcmCache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+constexpr std::array<char, 4> kMagic = {'S', 'R', 'P', 'C'};
+constexpr uint32_t kVersion = 2;
+constexpr char kExtension[] = ".pcm";
+
+// Fixed layout, little-endian, sized so the samples that follow are aligned.
+struct Header {
+  std::array<char, 4> magic;
+  uint32_t version;
+  uint64_t key_hash;
+  uint64_t file_size;
+  int64_t modified_time;
+  uint64_t content_hash;
+  uint32_t channels;
+  uint32_t sample_rate;
+  uint64_t frame_count;
+  uint64_t path_hash;
+  float peak;
+  float loudness_db;
+  uint64_t first_sound_frame;
+};
+static_assert(sizeof(Header) == 80);
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t Fnv1a(const void* data, const size_t size,
+               uint64_t hash = kFnvOffset) {
+  const auto bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+template <typename T>
+uint64_t Fnv1a(const T& value, const uint64_t hash) {
+  return Fnv1a(&value, sizeof(value), hash);
+}
+
+uint64_t PathHash(const std::string& path) {
+  return Fnv1a(path.data(), path.size());
+}
+
+}  // namespace
+
+uint64_t PcmCacheKey::Hash() const {
+  uint64_t hash = PathHash(path);
+  hash = Fnv1a(file_size, hash);
+  hash = Fnv1a(modified_time, hash);
+  hash = Fnv1a(content_hash, hash);
+  hash = Fnv1a(channels, hash);
+  hash = Fnv1a(sample_rate, hash);
+  return hash;
+}
+
+std::optional<PcmCacheKey> PcmCache::MakeKey(const std::string& path,
+                                             const uint32_t channels,
+                                             const uint32_t sample_rate) {
+  std::error_code error;
+  PcmCacheKey key;
+  key.path = path;
+  key.file_size = std::filesystem::file_size(path, error);
+  if (error) return std::nullopt;
+  key.modified_time =
+      std::filesystem::last_write_time(path, error).time_since_epoch().count();
+  if (error) return std::nullopt;
+  key.channels = channels;
+  key.sample_rate = sample_rate;
+
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return std::nullopt;
+  std::vector<char> chunk(1 << 16);
+  uint64_t hash = kFnvOffset;
+  uint64_t read = 0;
+  while (file) {
+    file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    const auto count = static_cast<size_t>(file.gcount());
+    hash = Fnv1a(chunk.data(), count, hash);
+    read += count;
+  }
+  // changed while we were reading it
+  if (read != key.file_size) return std::nullopt;
+  key.content_hash = hash;
+  return key;
+}
+
+std::optional<PcmCache::Entry> PcmCache::Find(const PcmCacheKey& key) {
+  const auto path = EntryPath(key);
+  auto entry = Validate(MappedFile::Open(path), key);
+  if (!entry) return std::nullopt;
+  // the modified time doubles as the last use for Trim
+  std::error_code error;
+  std::filesystem::last_write_time(
+      path, std::filesystem::file_time_type::clock::now(), error);
+  return entry;
+}
+
+std::optional<PcmCache::Entry> PcmCache::Store(const PcmCacheKey& key,
+                                               const float* samples,
+                                               const uint64_t frame_count,
+                                               const PcmAnalysis& analysis) {
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  if (error) return std::nullopt;
+
+  Header header{};
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.key_hash = key.Hash();
+  header.file_size = key.file_size;
+  header.modified_time = key.modified_time;
+  header.content_hash = key.content_hash;
+  header.channels = key.channels;
+  header.sample_rate = key.sample_rate;
+  header.frame_count = frame_count;
+  header.path_hash = PathHash(key.path);
+  header.peak = analysis.peak;
+  header.loudness_db = analysis.loudness_db;
+  header.first_sound_frame = analysis.first_sound_frame;
+
+  const auto path = EntryPath(key);
+  auto temporary_path = path;
+  temporary_path += ".tmp";
+  std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(samples),
+             static_cast<std::streamsize>(frame_count * key.channels *
+                                          sizeof(float)));
+  // closing flushes, which is where a full disk shows up
+  file.close();
+  if (file.fail()) {
+    std::filesystem::remove(temporary_path, error);
+    return std::nullopt;
+  }
+  std::filesystem::rename(temporary_path, path, error);
+  if (error) {
+    std::filesystem::remove(temporary_path, error);
+    return std::nullopt;
+  }
+
+  Trim();
+  return Validate(MappedFile::Open(path), key);
+}
+
+void PcmCache::Trim() {
+  struct CachedFile {
+    std::filesystem::path path;
+    std::filesystem::file_time_type last_used;
+    uint64_t size;
+  };
+  std::vector<CachedFile> files;
+  uint64_t total = 0;
+  std::error_code error;
+  for (const auto& file :
+       std::filesystem::directory_iterator(directory_, error)) {
+    if (!file.is_regular_file(error)) continue;
+    if (file.path().extension() != kExtension) continue;
+    const auto size = file.file_size(error);
+    if (error) continue;
+    files.push_back({file.path(), file.last_write_time(error), size});
+    total += size;
+  }
+  if (total <= max_bytes_) return;
+
+  std::sort(files.begin(), files.end(),
+            [](const CachedFile& a, const CachedFile& b) {
+              return a.last_used < b.last_used;
+            });
+  for (const auto& file : files) {
+    if (total <= max_bytes_) break;
+    // entries that are mapped right now may refuse to go, that's fine
+    if (std::filesystem::remove(file.path, error)) total -= file.size;
+  }
+}
+
+std::filesystem::path PcmCache::EntryPath(const PcmCacheKey& key) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx%s",
+                static_cast<unsigned long long>(key.Hash()), kExtension);
+  return directory_ / name;
+}
+
+std::optional<PcmCache::Entry> PcmCache::Validate(
+    std::unique_ptr<MappedFile> file, const PcmCacheKey& key) {
+  if (!file || file->Size() < sizeof(Header)) return std::nullopt;
+  Header header;
+  std::memcpy(&header, file->Data(), sizeof(header));
+  if (header.magic != kMagic || header.version != kVersion ||
+      header.key_hash != key.Hash() || header.file_size != key.file_size ||
+      header.modified_time != key.modified_time ||
+      header.content_hash != key.content_hash ||
+      header.channels != key.channels ||
+      header.sample_rate != key.sample_rate ||
+      header.path_hash != PathHash(key.path)) {
+    return std::nullopt;
+  }
+  // Sized from the file rather than the header, so a torn write or a
+  // frame_count large enough to overflow can't map past the end.
+  const uint64_t frame_bytes = uint64_t{header.channels} * sizeof(float);
+  const uint64_t sample_bytes = file->Size() - sizeof(Header);
+  if (frame_bytes == 0 || sample_bytes % frame_bytes != 0 ||
+      header.frame_count != sample_bytes / frame_bytes ||
+      header.first_sound_frame > header.frame_count) {
+    return std::nullopt;
+  }
+
+  Entry entry;
+  entry.samples = reinterpret_cast<const float*>(file->Data() + sizeof(Header));
+  entry.frame_count = header.frame_count;
+  entry.analysis.peak = header.peak;
+  entry.analysis.loudness_db = header.loudness_db;
+  entry.analysis.first_sound_frame = header.first_sound_frame;
+  entry.analysis.frame_count = header.frame_count;
+  entry.file = std::move(file);
+  return entry;
+}
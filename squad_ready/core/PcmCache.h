@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "MappedFile.h"
+#include "PcmAnalysis.h"
+
+// Identifies one decoded source file. A cache entry is only used if every
+// field matches, so editing, replacing or touching the source file, or the
+// audio device changing format, all miss.
+struct PcmCacheKey {
+  std::string path;
+  uint64_t file_size = 0;
+  int64_t modified_time = 0;
+  uint64_t content_hash = 0;
+  // format of the cached PCM, always interleaved f32
+  uint32_t channels = 0;
+  uint32_t sample_rate = 0;
+
+  uint64_t Hash() const;
+};
+
+// On-disk cache of decoded PCM in the audio device's format, so a warm start
+// maps the samples straight from the file instead of decoding MP3/FLAC.
+//
+// Each entry is one file named after the key hash: an 80 byte header that
+// repeats the key and holds the PcmAnalysis of the samples, followed by the
+// samples. Entries are written to a
+// temporary file and renamed into place, and the directory is kept under a
+// byte budget by deleting the least recently used entries.
+class PcmCache {
+ public:
+  struct Entry {
+    std::unique_ptr<MappedFile> file;
+    const float* samples = nullptr;
+    uint64_t frame_count = 0;
+    PcmAnalysis analysis;
+  };
+
+  PcmCache(std::filesystem::path directory, uint64_t max_bytes)
+      : directory_(std::move(directory)), max_bytes_(max_bytes) {}
+
+  // Stats and hashes the source file, nullopt if it cannot be read.
+  static std::optional<PcmCacheKey> MakeKey(const std::string& path,
+                                            uint32_t channels,
+                                            uint32_t sample_rate);
+
+  // nullopt on a miss or a stale/corrupt entry.
+  std::optional<Entry> Find(const PcmCacheKey& key);
+  // Writes frame_count frames of interleaved samples and their analysis for
+  // key and returns the new entry mapped, then trims the cache to its budget.
+  std::optional<Entry> Store(const PcmCacheKey& key, const float* samples,
+                             uint64_t frame_count,
+                             const PcmAnalysis& analysis);
+  // Deletes least recently used entries until the cache fits its budget.
+  void Trim();
+
+  const std::filesystem::path& Directory() const { return directory_; }
+
+ private:
+  std::filesystem::path EntryPath(const PcmCacheKey& key) const;
+  static std::optional<Entry> Validate(std::unique_ptr<MappedFile> file,
+                                       const PcmCacheKey& key);
+
+  std::filesystem::path directory_;
+  uint64_t max_bytes_;
+};
@@ -0,0 +1,169 @@
+#include "ReadyCheckTracker.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+float ClampNagInterval(const float seconds) {
+  if (std::isnan(seconds)) return kMinNagIntervalSeconds;
+  return std::clamp(seconds, kMinNagIntervalSeconds, kMaxNagIntervalSeconds);
+}
+
+SquadTransition ReadyCheckTracker::ApplyBatch(
+    const UserDelta* updated_users, const size_t updated_users_count,
+    const std::string_view self_account_name) {
+  const auto now = clock_.Now();
+  const Roster::Mask members_before = state_.Players().EligibleMask();
+  const auto transition =
+      state_.ApplyBatch(updated_users, updated_users_count, self_account_name,
+                        now);
+  switch (transition.event) {
+    case SquadEvent::ReadyCheckStarted:
+      ReadyCheckStarted();
+      break;
+    case SquadEvent::ReadyCheckCompleted:
+      ReadyCheckCompleted();
+      break;
+    case SquadEvent::ReadyCheckEnded:
+      ReadyCheckCancelled();
+      break;
+    default:
+      break;
+  }
+  SquadChanged(transition, members_before);
+  UpdateNagTimer();
+  RecordLatency(updated_users, updated_users_count, transition, now,
+                std::popcount(members_before));
+  PublishSnapshot();
+  return transition;
+}
+
+void ReadyCheckTracker::Reset() {
+  if (latency_.InCheck()) {
+    latency_.EndCheck(clock_.Now(), false,
+                      std::popcount(state_.Players().EligibleMask()));
+  }
+  state_.Forget();
+  timers_.Clear();
+  PublishSnapshot();
+}
+
+bool ReadyCheckTracker::Tick() {
+  bool ran = false;
+  bool nagged = false;
+  timers_.RunDue(clock_.Now(), [&](const ReadyCheckTimer timer) {
+    ran = true;
+    switch (timer) {
+      case ReadyCheckTimer::Nag:
+        nagged |= Nag();
+        break;
+      default:
+        break;
+    }
+  });
+  if (ran) PublishSnapshot();
+  return nagged;
+}
+
+void ReadyCheckTracker::ReadyCheckStarted() {
+  ScheduleNag();
+  FlashWindow();
+  audio_.Play(SoundEvent::ReadyCheckStarted);
+}
+
+void ReadyCheckTracker::ReadyCheckCompleted() {
+  FlashWindow();
+  audio_.Play(SoundEvent::SquadReady);
+}
+
+void ReadyCheckTracker::ReadyCheckCancelled() {
+  audio_.Play(SoundEvent::ReadyCheckCancelled);
+}
+
+void ReadyCheckTracker::SquadChanged(const SquadTransition& transition,
+                                     const Roster::Mask members_before) {
+  // only set while the check goes on, the last subgroup readying is squad
+  // ready instead
+  if (transition.readied_subgroups != 0) {
+    audio_.Play(SoundEvent::SubgroupReady);
+  }
+  // not when self joins or the squad is first seen, everyone is new then, nor
+  // when self left the squad later in the batch
+  if (transition.joined_members != 0 && members_before != 0 &&
+      !state_.Players().Empty()) {
+    audio_.Play(SoundEvent::MemberJoined);
+  }
+}
+
+bool ReadyCheckTracker::Nag() {
+  // keep firing while the check is open even if the nag is disabled, so
+  // enabling it mid check takes effect
+  ScheduleNag();
+  if (!config_.ready_check_nag) return false;
+  FlashWindow();
+  audio_.Play(SoundEvent::ReadyCheckNag);
+  return true;
+}
+
+void ReadyCheckTracker::ScheduleNag() {
+  const std::chrono::duration<float> interval(
+      ClampNagInterval(config_.ready_check_nag_interval_seconds));
+  timers_.Schedule(
+      ReadyCheckTimer::Nag,
+      clock_.Now() +
+          std::chrono::duration_cast<std::chrono::milliseconds>(interval));
+}
+
+void ReadyCheckTracker::UpdateNagTimer() {
+  // only nag while self still has to ready up
+  if (!state_.InReadyCheck() || state_.SelfReadied()) {
+    timers_.Cancel(ReadyCheckTimer::Nag);
+  } else if (!timers_.Scheduled(ReadyCheckTimer::Nag)) {
+    ScheduleNag();
+  }
+}
+
+void ReadyCheckTracker::FlashWindow() {
+  if (!config_.flash_window) return;
+  window_.FlashWindow();
+}
+
+void ReadyCheckTracker::RecordLatency(const UserDelta* updated_users,
+                                      const size_t updated_users_count,
+                                      const SquadTransition& transition,
+                                      const Clock::time_point now,
+                                      const size_t members_before) {
+  if (transition.event == SquadEvent::ReadyCheckStarted) {
+    latency_.BeginCheck(now);
+  }
+  if (latency_.InCheck()) {
+    for (size_t i = 0; i < updated_users_count; i++) {
+      const auto& user = updated_users[i];
+      // the leader readying is what starts the check
+      if (!user.ready || (user.role != SquadRole::Lieutenant &&
+                          user.role != SquadRole::Member)) {
+        continue;
+      }
+      latency_.MemberReadied(user.AccountName(), user.hash, now);
+    }
+  }
+  if (transition.event == SquadEvent::ReadyCheckCompleted ||
+      transition.event == SquadEvent::ReadyCheckEnded) {
+    // self leaving clears the roster, report the squad it left
+    const size_t members = std::popcount(state_.Players().EligibleMask());
+    latency_.EndCheck(now, transition.event == SquadEvent::ReadyCheckCompleted,
+                      members != 0 ? members : members_before);
+  }
+}
+
+void ReadyCheckTracker::PublishSnapshot() {
+  snapshots_.PublishInPlace([this](SquadSnapshot& snapshot) {
+    snapshot.players = state_.Players();
+    snapshot.in_ready_check = state_.InReadyCheck();
+    snapshot.self_readied = state_.SelfReadied();
+    snapshot.subgroups_readied = state_.SubgroupsReadied();
+    snapshot.ready_check_start_time = state_.ReadyCheckStartTime();
+    snapshot.ready_check_nag_time = ReadyCheckNagTime();
+    snapshot.version = ++snapshot_version_;
+  });
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "DeadlineQueue.h"
+#include "ReadyLatency.h"
+#include "Sinks.h"
+#include "SnapshotPublisher.h"
+#include "SquadState.h"
+
+// Settings the state machine depends on, pushed in by the owner.
+struct ReadyCheckConfig {
+  bool flash_window = true;
+  bool ready_check_nag = false;
+  float ready_check_nag_interval_seconds = 5.0f;
+};
+
+// Bounds of the nag interval. Settings, the options panel and the tracker all
+// clamp to them, a zero or negative interval would nag on every tick.
+constexpr float kMinNagIntervalSeconds = 0.1f;
+constexpr float kMaxNagIntervalSeconds = 3600.0f;
+
+// The interval clamped to the bounds above, the minimum if it isn't a number.
+float ClampNagInterval(float seconds);
+
+// Immutable copy of the tracker state, published after every change for
+// readers outside the update path (debug window, options panel, overlays).
+struct SquadSnapshot {
+  using Clock = SquadState::Clock;
+
+  Roster players;
+  bool in_ready_check = false;
+  bool self_readied = false;
+  uint16_t subgroups_readied = 0;
+  Clock::time_point ready_check_start_time;
+  Clock::time_point ready_check_nag_time;
+  // bumped on every publish
+  uint64_t version = 0;
+};
+
+// Delayed actions owned by the tracker.
+enum class ReadyCheckTimer : uint8_t {
+  Nag,
+  Count,
+};
+
+// Ready check state machine: applies squad update batches, raises the ready
+// check/squad ready alerts and nags while self is not readied.
+class ReadyCheckTracker {
+ public:
+  using Clock = ClockSink::Clock;
+  static constexpr Clock::time_point kNoDeadline = Clock::time_point::max();
+
+  ReadyCheckTracker(AudioSink& audio, WindowSink& window,
+                    const ClockSink& clock)
+      : audio_(audio), window_(window), clock_(clock) {}
+
+  void SetConfig(const ReadyCheckConfig& config) { config_ = config; }
+  const ReadyCheckConfig& Config() const { return config_; }
+
+  SquadTransition ApplyBatch(const UserDelta* updated_users,
+                             size_t updated_users_count,
+                             std::string_view self_account_name);
+  // Forgets the squad and ends any ready check without an alert, for when
+  // updates were lost and the roster can't be trusted. The squad fills in
+  // again from the updates that follow.
+  void Reset();
+  // Runs the timers that are due, returns true if it nagged. Only needs to be
+  // called once NextDeadline() has passed.
+  bool Tick();
+  // kNoDeadline if nothing is scheduled.
+  Clock::time_point NextDeadline() const { return timers_.NextDeadline(); }
+
+  const SquadState& State() const { return state_; }
+  // Zero if no nag is scheduled.
+  Clock::time_point ReadyCheckNagTime() const {
+    return timers_.Scheduled(ReadyCheckTimer::Nag)
+               ? timers_.Deadline(ReadyCheckTimer::Nag)
+               : Clock::time_point{};
+  }
+  // Update thread only, too large to copy into every snapshot.
+  const ReadyLatency& Latency() const { return latency_; }
+  // Safe to call from any thread, never blocks the update path.
+  SnapshotPublisher<SquadSnapshot>::Reader Snapshot() const {
+    return snapshots_.Read();
+  }
+
+ private:
+  void ReadyCheckStarted();
+  void ReadyCheckCompleted();
+  void ReadyCheckCancelled();
+  // Sounds for squad changes outside the start and end of a check.
+  void SquadChanged(const SquadTransition& transition,
+                    Roster::Mask members_before);
+  bool Nag();
+  void ScheduleNag();
+  void UpdateNagTimer();
+  void FlashWindow();
+  void RecordLatency(const UserDelta* updated_users,
+                     size_t updated_users_count,
+                     const SquadTransition& transition, Clock::time_point now,
+                     size_t members_before);
+  void PublishSnapshot();
+
+  AudioSink& audio_;
+  WindowSink& window_;
+  const ClockSink& clock_;
+  ReadyCheckConfig config_;
+  SquadState state_;
+  DeadlineQueue<ReadyCheckTimer, static_cast<size_t>(ReadyCheckTimer::Count)>
+      timers_;
+  ReadyLatency latency_;
+  SnapshotPublisher<SquadSnapshot> snapshots_;
+  uint64_t snapshot_version_ = 0;
+};
@@ -0,0 +1,119 @@
+#include "ReadyLatency.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+void LatencyHistogram::Record(uint32_t ms) {
+  ms = std::min(ms, kMaxValue);
+  counts_[Bucket(ms)]++;
+  count_++;
+  max_ = std::max(max_, ms);
+}
+
+uint32_t LatencyHistogram::Percentile(const double p) const {
+  if (count_ == 0) return 0;
+  const auto rank = std::max<uint32_t>(
+      1, static_cast<uint32_t>(std::ceil(std::clamp(p, 0.0, 1.0) * count_)));
+  uint32_t seen = 0;
+  for (size_t bucket = 0; bucket < kBuckets; bucket++) {
+    seen += counts_[bucket];
+    if (seen >= rank) return std::min(BucketUpperBound(bucket), max_);
+  }
+  return max_;
+}
+
+size_t LatencyHistogram::Bucket(const uint32_t ms) {
+  if (ms < kSubBuckets) return ms;
+  const uint32_t octave = std::bit_width(ms) - 1;
+  const uint32_t shift = octave - kSubBucketBits;
+  const uint32_t sub_bucket = (ms >> shift) & (kSubBuckets - 1);
+  return kSubBuckets + shift * kSubBuckets + sub_bucket;
+}
+
+uint32_t LatencyHistogram::BucketUpperBound(const size_t bucket) {
+  if (bucket < kSubBuckets) return static_cast<uint32_t>(bucket);
+  const auto shift = static_cast<uint32_t>((bucket - kSubBuckets) / kSubBuckets);
+  const auto sub_bucket =
+      static_cast<uint32_t>((bucket - kSubBuckets) % kSubBuckets);
+  const uint32_t lower = (kSubBuckets + sub_bucket) << shift;
+  return lower + (1u << shift) - 1;
+}
+
+namespace {
+
+uint32_t MillisecondsBetween(const ReadyLatency::Clock::time_point from,
+                             const ReadyLatency::Clock::time_point to) {
+  const auto ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count();
+  return static_cast<uint32_t>(
+      std::clamp<int64_t>(ms, 0, LatencyHistogram::kMaxValue));
+}
+
+}  // namespace
+
+void ReadyLatency::BeginCheck(const Clock::time_point start_time) {
+  in_check_ = true;
+  check_sequence_++;
+  current_ = {};
+  current_.start_time = start_time;
+  readied_.reset();
+}
+
+void ReadyLatency::MemberReadied(const std::string_view account_name,
+                                 const uint32_t hash,
+                                 const Clock::time_point now) {
+  if (!in_check_) return;
+  const size_t index = FindOrClaimAccount(account_name, hash);
+  if (readied_.test(index)) return;
+  readied_.set(index);
+
+  auto& account = accounts_[index];
+  account.last_check = check_sequence_;
+  const uint32_t ms = MillisecondsBetween(current_.start_time, now);
+  account.histogram.Record(ms);
+
+  if (current_.readied < UINT8_MAX) current_.readied++;
+  if (ms >= current_.slowest_ms) {
+    current_.slowest_ms = ms;
+    current_.slowest_account_name = account.account_name;
+  }
+}
+
+void ReadyLatency::EndCheck(const Clock::time_point now, const bool completed,
+                            const size_t members) {
+  if (!in_check_) return;
+  in_check_ = false;
+  current_.duration_ms = MillisecondsBetween(current_.start_time, now);
+  current_.completed = completed;
+  current_.members = static_cast<uint8_t>(std::min<size_t>(members, UINT8_MAX));
+  if (completed) squad_.Record(current_.duration_ms);
+
+  recent_[recent_next_] = current_;
+  recent_next_ = (recent_next_ + 1) % kRecentChecks;
+  recent_count_ = std::min(recent_count_ + 1, kRecentChecks);
+}
+
+size_t ReadyLatency::FindOrClaimAccount(const std::string_view account_name,
+                                        const uint32_t hash) {
+  const auto name =
+      account_name.substr(0, kMaxAccountNameLength - 1);
+  size_t victim = 0;
+  for (size_t i = 0; i < kMaxAccounts; i++) {
+    const auto& account = accounts_[i];
+    if (account.last_check != 0 && account.hash == hash &&
+        account.AccountName() == name) {
+      return i;
+    }
+    if (account.last_check < accounts_[victim].last_check) victim = i;
+  }
+
+  // unused, or the account that readied least recently
+  auto& account = accounts_[victim];
+  account = {};
+  std::copy(name.begin(), name.end(), account.account_name.begin());
+  account.hash = hash;
+  account.last_check = check_sequence_;
+  readied_.reset(victim);
+  return victim;
+}
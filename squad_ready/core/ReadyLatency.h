@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Log-bucketed histogram of millisecond latencies in fixed memory. Values
+// below 8ms are exact, above that each power of two is split into 8 buckets,
+// so a reported percentile is within 12.5% of the true value.
+class LatencyHistogram {
+ public:
+  static constexpr uint32_t kSubBucketBits = 3;
+  static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;
+  // ~70 minutes, anything longer is clamped
+  static constexpr uint32_t kMaxOctave = 21;
+  static constexpr size_t kBuckets =
+      kSubBuckets + (kMaxOctave - kSubBucketBits + 1) * kSubBuckets;
+  static constexpr uint32_t kMaxValue = (2u << kMaxOctave) - 1;
+
+  void Record(uint32_t ms);
+  void Clear() { *this = {}; }
+
+  uint32_t Count() const { return count_; }
+  uint32_t Max() const { return max_; }
+  // Upper bound of the bucket holding the p-th (0-1) value, 0 if empty.
+  uint32_t Percentile(double p) const;
+
+ private:
+  static size_t Bucket(uint32_t ms);
+  static uint32_t BucketUpperBound(size_t bucket);
+
+  std::array<uint32_t, kBuckets> counts_{};
+  uint32_t count_ = 0;
+  uint32_t max_ = 0;
+};
+
+// Outcome of one ready check, kept in a ring of recent checks.
+struct ReadyCheckSummary {
+  using Clock = std::chrono::steady_clock;
+
+  Clock::time_point start_time;
+  // start to squad ready, or to the check ending
+  uint32_t duration_ms = 0;
+  bool completed = false;
+  uint8_t members = 0;
+  uint8_t readied = 0;
+  std::array<char, 64> slowest_account_name{};
+  uint32_t slowest_ms = 0;
+};
+
+// How long each member takes to ready up after a ready check starts, and how
+// long the whole squad takes, over a bounded set of accounts and a ring of
+// recent checks. Memory use is fixed no matter how many checks or pugs pass
+// through in a session: when the account table is full, the account that
+// was seen least recently is forgotten.
+class ReadyLatency {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr size_t kMaxAccounts = 128;
+  static constexpr size_t kRecentChecks = 32;
+  static constexpr size_t kMaxAccountNameLength = 64;
+
+  struct Account {
+    std::array<char, kMaxAccountNameLength> account_name{};
+    uint32_t hash = 0;
+    // check sequence number the account last readied in, 0 for unused
+    uint64_t last_check = 0;
+    LatencyHistogram histogram;
+
+    std::string_view AccountName() const { return account_name.data(); }
+  };
+
+  void BeginCheck(Clock::time_point start_time);
+  // Only the first ready of each account per check counts.
+  void MemberReadied(std::string_view account_name, uint32_t hash,
+                     Clock::time_point now);
+  void EndCheck(Clock::time_point now, bool completed, size_t members);
+
+  bool InCheck() const { return in_check_; }
+  const LatencyHistogram& SquadHistogram() const { return squad_; }
+  uint64_t CheckCount() const { return check_sequence_; }
+
+  // f(const Account&) for every tracked account.
+  template <typename F>
+  void ForEachAccount(F&& f) const {
+    for (const auto& account : accounts_) {
+      if (account.last_check != 0) f(account);
+    }
+  }
+  // f(const ReadyCheckSummary&) from newest to oldest.
+  template <typename F>
+  void ForEachRecentCheck(F&& f) const {
+    for (size_t i = 0; i < recent_count_; i++) {
+      f(recent_[(recent_next_ + kRecentChecks - 1 - i) % kRecentChecks]);
+    }
+  }
+
+ private:
+  size_t FindOrClaimAccount(std::string_view account_name, uint32_t hash);
+
+  std::array<Account, kMaxAccounts> accounts_;
+  LatencyHistogram squad_;
+  std::array<ReadyCheckSummary, kRecentChecks> recent_;
+  size_t recent_next_ = 0;
+  size_t recent_count_ = 0;
+
+  // current check
+  bool in_check_ = false;
+  uint64_t check_sequence_ = 0;
+  ReadyCheckSummary current_;
+  std::bitset<kMaxAccounts> readied_;
+};
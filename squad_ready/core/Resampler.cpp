@@ -0,0 +1,186 @@
+#include "Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SQUAD_READY_RESAMPLER_SSE2
+#endif
+
+namespace {
+
+// Filter taps each side of the output position when upsampling, scaled up
+// with the ratio when downsampling so the narrower cutoff keeps its shape.
+constexpr uint32_t kHalfTaps = 16;
+constexpr uint32_t kMaxHalfTaps = 64;
+// Rate pairs needing more phases than this round the position to one.
+constexpr uint32_t kMaxPhases = 512;
+// Of the lower Nyquist frequency, leaves room for the transition band.
+constexpr double kPassband = 0.92;
+
+float Dot(const float* a, const float* b, const uint32_t count) {
+#ifdef SQUAD_READY_RESAMPLER_SSE2
+  // count is always a multiple of 4
+  __m128 sum = _mm_setzero_ps();
+  for (uint32_t i = 0; i < count; i += 4) {
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, sum);
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+  float sum = 0.0f;
+  for (uint32_t i = 0; i < count; i++) sum += a[i] * b[i];
+  return sum;
+#endif
+}
+
+// One set of taps per fractional input position.
+class PolyphaseFilter {
+ public:
+  PolyphaseFilter(const uint32_t in_rate, const uint32_t out_rate) {
+    const uint32_t divisor = std::gcd(in_rate, out_rate);
+    up_ = out_rate / divisor;
+    down_ = in_rate / divisor;
+    phases_ = std::min(up_, kMaxPhases);
+    const double ratio = static_cast<double>(out_rate) / in_rate;
+    half_taps_ = std::min(kMaxHalfTaps,
+                          static_cast<uint32_t>(std::ceil(
+                              kHalfTaps * std::max(1.0, 1.0 / ratio))));
+    // keeps the taps a multiple of 4 for Dot
+    half_taps_ += half_taps_ % 2;
+    // cycles per input sample
+    const double cutoff = 0.5 * std::min(1.0, ratio) * kPassband;
+
+    coefficients_.resize(static_cast<size_t>(phases_) * Taps());
+    for (uint32_t phase = 0; phase < phases_; phase++) {
+      const double fraction = static_cast<double>(phase) / phases_;
+      float* taps = &coefficients_[static_cast<size_t>(phase) * Taps()];
+      double sum = 0.0;
+      for (uint32_t j = 0; j < Taps(); j++) {
+        // distance from the output position to the input sample under tap j
+        const double x = fraction + half_taps_ - 1.0 - j;
+        const double value = 2 * cutoff * Sinc(2 * cutoff * x) *
+                             Blackman(x / half_taps_);
+        taps[j] = static_cast<float>(value);
+        sum += value;
+      }
+      // unity gain at DC for every phase
+      for (uint32_t j = 0; j < Taps(); j++) {
+        taps[j] = static_cast<float>(taps[j] / sum);
+      }
+    }
+  }
+
+  uint32_t Taps() const { return 2 * half_taps_; }
+  uint32_t HalfTaps() const { return half_taps_; }
+
+  // Input frame at or before output frame n, and the taps to apply from
+  // HalfTaps() - 1 frames before it.
+  uint64_t InputFrame(const uint64_t n) const { return n * down_ / up_; }
+  const float* Taps(const uint64_t n) const {
+    const uint64_t remainder = n * down_ % up_;
+    const uint64_t phase = remainder * phases_ / up_;
+    return &coefficients_[phase * Taps()];
+  }
+
+ private:
+  static double Sinc(const double x) {
+    if (std::abs(x) < 1e-9) return 1.0;
+    return std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+  }
+  static double Blackman(const double u) {
+    if (std::abs(u) >= 1.0) return 0.0;
+    return 0.42 + 0.5 * std::cos(std::numbers::pi * u) +
+           0.08 * std::cos(2 * std::numbers::pi * u);
+  }
+
+  uint32_t up_;
+  uint32_t down_;
+  uint32_t phases_;
+  uint32_t half_taps_;
+  std::vector<float> coefficients_;
+};
+
+std::vector<float> Resample(const float* samples, const uint64_t frame_count,
+                            const uint32_t channels, const uint32_t in_rate,
+                            const uint32_t out_rate) {
+  const PolyphaseFilter filter(in_rate, out_rate);
+  const uint64_t out_frames =
+      resampler::OutputFrames(frame_count, in_rate, out_rate);
+  std::vector<float> out(out_frames * channels);
+
+  // one channel at a time, contiguous and padded with silence so the taps
+  // never run off either end
+  const uint64_t padding = filter.Taps();
+  std::vector<float> channel(frame_count + 2 * padding, 0.0f);
+  for (uint32_t c = 0; c < channels; c++) {
+    for (uint64_t i = 0; i < frame_count; i++) {
+      channel[padding + i] = samples[i * channels + c];
+    }
+    const float* base = channel.data() + padding - (filter.HalfTaps() - 1);
+    for (uint64_t n = 0; n < out_frames; n++) {
+      out[n * channels + c] =
+          Dot(filter.Taps(n), base + filter.InputFrame(n), filter.Taps());
+    }
+  }
+  return out;
+}
+
+std::vector<float> Remix(const float* samples, const uint64_t frame_count,
+                         const uint32_t in_channels,
+                         const uint32_t out_channels) {
+  std::vector<float> out(frame_count * out_channels, 0.0f);
+  for (uint64_t i = 0; i < frame_count; i++) {
+    const float* in_frame = samples + i * in_channels;
+    float* out_frame = &out[i * out_channels];
+    if (in_channels == 1) {
+      std::fill_n(out_frame, std::min(out_channels, 2u), in_frame[0]);
+    } else if (out_channels == 1) {
+      out_frame[0] = std::accumulate(in_frame, in_frame + in_channels, 0.0f) /
+                     in_channels;
+    } else {
+      std::copy_n(in_frame, std::min(in_channels, out_channels), out_frame);
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+namespace resampler {
+
+uint64_t OutputFrames(const uint64_t frame_count, const uint32_t in_rate,
+                      const uint32_t out_rate) {
+  if (in_rate == out_rate) return frame_count;
+  return (frame_count * out_rate + in_rate - 1) / in_rate;
+}
+
+std::vector<float> Convert(const float* samples, const uint64_t frame_count,
+                           const uint32_t in_channels, const uint32_t in_rate,
+                           const uint32_t out_channels,
+                           const uint32_t out_rate) {
+  if (in_rate == out_rate) {
+    if (in_channels == out_channels) {
+      return {samples, samples + frame_count * in_channels};
+    }
+    return Remix(samples, frame_count, in_channels, out_channels);
+  }
+  // resample whichever side has fewer channels
+  if (out_channels < in_channels) {
+    const auto remixed = Remix(samples, frame_count, in_channels, out_channels);
+    return Resample(remixed.data(), frame_count, out_channels, in_rate,
+                    out_rate);
+  }
+  const auto resampled =
+      Resample(samples, frame_count, in_channels, in_rate, out_rate);
+  if (in_channels == out_channels) return resampled;
+  return Remix(resampled.data(), OutputFrames(frame_count, in_rate, out_rate),
+               in_channels, out_channels);
+}
+
+}  // namespace resampler
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Converts interleaved f32 PCM to another sample rate and channel count once,
+// when a sound is loaded, so the mixer only has to copy it. Resampling is a
+// windowed-sinc polyphase filter with its dot products in SSE2 where
+// available. Channels map mono to the front pair, average down to mono, and
+// otherwise keep the first channels and leave any extra ones silent.
+namespace resampler {
+
+// Frames Convert produces for frame_count input frames.
+uint64_t OutputFrames(uint64_t frame_count, uint32_t in_rate,
+                      uint32_t out_rate);
+
+std::vector<float> Convert(const float* samples, uint64_t frame_count,
+                           uint32_t in_channels, uint32_t in_rate,
+                           uint32_t out_channels, uint32_t out_rate);
+
+}  // namespace resampler
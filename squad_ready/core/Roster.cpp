@@ -0,0 +1,149 @@
+#include "Roster.h"
+
+#include <algorithm>
+
+std::string_view Roster::NormalizeAccountName(const char* account_name) {
+  if (account_name == nullptr) return {};
+  std::string_view name(account_name);
+  if (!name.empty() && name.front() == ':') name.remove_prefix(1);
+  return name;
+}
+
+uint32_t Roster::HashAccountName(std::string_view account_name) {
+  uint32_t hash = 2166136261u;
+  for (const char c : Truncate(account_name)) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+std::string_view Roster::Truncate(std::string_view account_name) {
+  return account_name.substr(
+      0, std::min(account_name.size(), kMaxAccountNameLength - 1));
+}
+
+size_t Roster::Probe(std::string_view account_name, uint32_t hash) const {
+  account_name = Truncate(account_name);
+  size_t index = hash & kSlotMask;
+  for (size_t i = 0; i < kCapacity; i++) {
+    if ((occupied_mask_ & Bit(index)) == 0) return index;
+    if (hashes_[index] == hash && AccountName(index) == account_name) {
+      return index;
+    }
+    index = (index + 1) & kSlotMask;
+  }
+  return kCapacity;
+}
+
+int Roster::Find(std::string_view account_name, uint32_t hash) const {
+  const size_t index = Probe(account_name, hash);
+  if (index == kCapacity || (occupied_mask_ & Bit(index)) == 0) {
+    return kNoSlot;
+  }
+  return static_cast<int>(index);
+}
+
+int Roster::FindOrInsert(std::string_view account_name, uint32_t hash,
+                         bool& inserted) {
+  inserted = false;
+  const size_t index = Probe(account_name, hash);
+  if (index == kCapacity) return kNoSlot;
+  if (occupied_mask_ & Bit(index)) return static_cast<int>(index);
+
+  account_name = Truncate(account_name);
+  auto& name = account_names_[index];
+  std::copy(account_name.begin(), account_name.end(), name.begin());
+  name[account_name.size()] = '\0';
+  hashes_[index] = hash;
+  join_times_[index] = 0;
+  roles_[index] = SquadRole::None;
+  subgroups_[index] = 0;
+  occupied_mask_ |= Bit(index);
+  inserted = true;
+  return static_cast<int>(index);
+}
+
+void Roster::Update(int slot, int64_t join_time, SquadRole role,
+                    uint8_t subgroup, bool ready) {
+  const Mask bit = Bit(slot);
+  if (subgroups_[slot] < kMaxSubgroups) {
+    subgroup_masks_[subgroups_[slot]] &= ~bit;
+  }
+  join_times_[slot] = join_time;
+  roles_[slot] = role;
+  subgroups_[slot] = subgroup;
+
+  eligible_mask_ =
+      Eligible(role) ? eligible_mask_ | bit : eligible_mask_ & ~bit;
+  ready_mask_ = ready ? ready_mask_ | bit : ready_mask_ & ~bit;
+  leader_mask_ = role == SquadRole::SquadLeader ? leader_mask_ | bit
+                                                : leader_mask_ & ~bit;
+  if (subgroup < kMaxSubgroups) subgroup_masks_[subgroup] |= bit;
+}
+
+bool Roster::Erase(std::string_view account_name, uint32_t hash) {
+  size_t hole = Probe(account_name, hash);
+  if (hole == kCapacity || (occupied_mask_ & Bit(hole)) == 0) return false;
+
+  // Backward shift deletion, so lookups never need tombstones.
+  size_t index = hole;
+  for (size_t i = 1; i < kCapacity; i++) {
+    index = (index + 1) & kSlotMask;
+    if ((occupied_mask_ & Bit(index)) == 0) break;
+    const size_t home = hashes_[index] & kSlotMask;
+    // Leave entries whose home slot lies cyclically in (hole, index].
+    const bool in_place = hole <= index ? (hole < home && home <= index)
+                                        : (hole < home || home <= index);
+    if (in_place) continue;
+    MoveSlot(index, hole);
+    hole = index;
+  }
+  ClearSlot(hole);
+  return true;
+}
+
+void Roster::Clear() {
+  occupied_mask_ = 0;
+  eligible_mask_ = 0;
+  ready_mask_ = 0;
+  leader_mask_ = 0;
+  subgroup_masks_.fill(0);
+}
+
+void Roster::ClearSlot(size_t slot) {
+  const Mask keep = ~Bit(slot);
+  occupied_mask_ &= keep;
+  eligible_mask_ &= keep;
+  ready_mask_ &= keep;
+  leader_mask_ &= keep;
+  if (subgroups_[slot] < kMaxSubgroups) {
+    subgroup_masks_[subgroups_[slot]] &= keep;
+  }
+}
+
+void Roster::MoveSlot(size_t from, size_t to) {
+  ClearSlot(to);
+  account_names_[to] = account_names_[from];
+  hashes_[to] = hashes_[from];
+  occupied_mask_ |= Bit(to);
+  Update(static_cast<int>(to), join_times_[from], roles_[from],
+         subgroups_[from], Ready(static_cast<int>(from)));
+  ClearSlot(from);
+}
+
+UserDelta UserDelta::Make(const char* account_name, const int64_t join_time,
+                          const SquadRole role, const uint8_t subgroup,
+                          const bool ready) {
+  UserDelta delta;
+  const auto name = Roster::NormalizeAccountName(account_name);
+  const size_t length =
+      std::min(name.size(), Roster::kMaxAccountNameLength - 1);
+  std::copy_n(name.begin(), length, delta.account_name.begin());
+  delta.hash = Roster::HashAccountName(name);
+  delta.join_time = join_time;
+  delta.role = role;
+  delta.subgroup = subgroup;
+  delta.ready = ready;
+  return delta;
+}
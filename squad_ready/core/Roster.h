@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Mirrors UserRole from unofficial extras, kept here so the roster does not
+// depend on the extras headers.
+enum class SquadRole : uint8_t {
+  SquadLeader = 0,
+  Lieutenant = 1,
+  Member = 2,
+  Invited = 3,
+  Applied = 4,
+  None = 5,
+  Invalid = 6
+};
+
+// Fixed capacity squad roster. Slots are open addressed by a hash of the
+// normalized account name, and names are stored inline so updating the roster
+// never allocates.
+//
+// Per-slot fields are kept as structure-of-arrays, and role, subgroup and
+// ready state are mirrored into 64-bit masks indexed by slot, so squad wide
+// questions ("is everyone ready?") are a mask compare instead of a walk.
+class Roster {
+ public:
+  // A squad holds at most 50 members, leave headroom for invites/applicants.
+  static constexpr size_t kCapacity = 64;
+  static constexpr size_t kMaxAccountNameLength = 64;
+  static constexpr size_t kMaxSubgroups = 16;
+  static constexpr int kNoSlot = -1;
+
+  using Mask = uint64_t;
+  static_assert(kCapacity <= sizeof(Mask) * 8, "slots must fit in a mask");
+
+  // Strips the leading ':' that unofficial extras prefixes account names with.
+  static std::string_view NormalizeAccountName(const char* account_name);
+  // FNV-1a over the (truncated) normalized account name.
+  static uint32_t HashAccountName(std::string_view account_name);
+  // Squad leader, lieutenants and members, ie. everyone a ready check waits
+  // on.
+  static bool Eligible(const SquadRole role) {
+    return role == SquadRole::SquadLeader || role == SquadRole::Lieutenant ||
+           role == SquadRole::Member;
+  }
+
+  // Returns kNoSlot if not present.
+  int Find(std::string_view account_name, uint32_t hash) const;
+  // Returns the existing slot or claims a new slot for the account. Returns
+  // kNoSlot if the roster is full.
+  int FindOrInsert(std::string_view account_name, uint32_t hash,
+                   bool& inserted);
+  void Update(int slot, int64_t join_time, SquadRole role, uint8_t subgroup,
+              bool ready);
+  bool Erase(std::string_view account_name, uint32_t hash);
+  void Clear();
+
+  size_t Size() const { return std::popcount(occupied_mask_); }
+  bool Empty() const { return occupied_mask_ == 0; }
+
+  std::string_view AccountName(int slot) const {
+    return account_names_[slot].data();
+  }
+  int64_t JoinTime(int slot) const { return join_times_[slot]; }
+  SquadRole Role(int slot) const { return roles_[slot]; }
+  uint8_t Subgroup(int slot) const { return subgroups_[slot]; }
+  bool Ready(int slot) const { return (ready_mask_ >> slot) & 1; }
+
+  Mask OccupiedMask() const { return occupied_mask_; }
+  // Slots of Eligible roles.
+  Mask EligibleMask() const { return eligible_mask_; }
+  Mask ReadyMask() const { return ready_mask_; }
+  Mask LeaderMask() const { return leader_mask_; }
+  Mask SubgroupMask(size_t subgroup) const {
+    return subgroup < kMaxSubgroups ? subgroup_masks_[subgroup] : 0;
+  }
+  Mask NotReadyMask() const { return eligible_mask_ & ~ready_mask_; }
+  size_t NotReadyCount() const { return std::popcount(NotReadyMask()); }
+
+  bool AllReady() const {
+    return eligible_mask_ != 0 && NotReadyMask() == 0;
+  }
+  bool SubgroupReady(size_t subgroup) const {
+    const Mask members = SubgroupMask(subgroup) & eligible_mask_;
+    return members != 0 && (members & ~ready_mask_) == 0;
+  }
+
+  // Calls f(slot) for each slot selected by mask, in slot order.
+  template <typename F>
+  static void ForEachSlot(Mask mask, F&& f) {
+    while (mask != 0) {
+      f(std::countr_zero(mask));
+      mask &= mask - 1;
+    }
+  }
+  template <typename F>
+  void ForEach(F&& f) const {
+    ForEachSlot(occupied_mask_, f);
+  }
+
+ private:
+  static constexpr size_t kSlotMask = kCapacity - 1;
+  static_assert((kCapacity & kSlotMask) == 0, "capacity must be a power of 2");
+
+  static std::string_view Truncate(std::string_view account_name);
+  static Mask Bit(size_t slot) { return Mask{1} << slot; }
+  size_t Probe(std::string_view account_name, uint32_t hash) const;
+  void ClearSlot(size_t slot);
+  void MoveSlot(size_t from, size_t to);
+
+  std::array<std::array<char, kMaxAccountNameLength>, kCapacity>
+      account_names_{};
+  std::array<uint32_t, kCapacity> hashes_{};
+  std::array<int64_t, kCapacity> join_times_{};
+  std::array<SquadRole, kCapacity> roles_{};
+  std::array<uint8_t, kCapacity> subgroups_{};
+
+  Mask occupied_mask_ = 0;
+  Mask eligible_mask_ = 0;
+  Mask ready_mask_ = 0;
+  Mask leader_mask_ = 0;
+  std::array<Mask, kMaxSubgroups> subgroup_masks_{};
+};
+
+// Compact, self contained copy of a single unofficial extras user update, so
+// it can be handed between threads without pointing into extras' memory.
+struct UserDelta {
+  std::array<char, Roster::kMaxAccountNameLength> account_name{};
+  uint32_t hash = 0;
+  int64_t join_time = 0;
+  SquadRole role = SquadRole::None;
+  uint8_t subgroup = 0;
+  bool ready = false;
+  // set on the last user of an update callback
+  bool batch_end = false;
+
+  static UserDelta Make(const char* account_name, int64_t join_time,
+                        SquadRole role, uint8_t subgroup, bool ready);
+
+  std::string_view AccountName() const { return account_name.data(); }
+};
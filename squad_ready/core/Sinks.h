@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+
+#include "SoundEvent.h"
+
+// Side effects of the ready check state machine. The plugin implements these
+// with miniaudio, FlashWindowEx and the steady clock, tools and benchmarks
+// with fakes.
+
+class AudioSink {
+ public:
+  virtual ~AudioSink() = default;
+  virtual void Play(SoundEvent event) = 0;
+};
+
+class WindowSink {
+ public:
+  virtual ~WindowSink() = default;
+  virtual void FlashWindow() = 0;
+};
+
+class ClockSink {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  virtual ~ClockSink() = default;
+  virtual Clock::time_point Now() const = 0;
+};
+
+// Fixed clock that only moves when told to, for replaying and benchmarking.
+class SimulatedClock final : public ClockSink {
+ public:
+  Clock::time_point Now() const override { return now_; }
+  void Set(Clock::time_point now) { now_ = now; }
+
+ private:
+  Clock::time_point now_{};
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Read-copy-update publication of an immutable value. One writer thread
+// publishes new versions with an atomic pointer swap, any number of readers
+// (up to kMaxReaders at the same time) pin the current version without ever
+// blocking the writer.
+//
+// Replaced versions are reclaimed by epoch: each active reader advertises the
+// epoch it entered at, and a retired version is only reused once no reader
+// that could still see it is active. Reclaimed versions are recycled, so a
+// steady stream of publishes does not allocate.
+template <typename T>
+class SnapshotPublisher {
+ public:
+  static constexpr size_t kMaxReaders = 8;
+
+  // Pins the version current at construction for its lifetime.
+  class Reader {
+   public:
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+    ~Reader() { publisher_.Exit(slot_); }
+
+    const T& operator*() const { return *value_; }
+    const T* operator->() const { return value_; }
+
+   private:
+    friend class SnapshotPublisher;
+    explicit Reader(const SnapshotPublisher& publisher)
+        : publisher_(publisher),
+          slot_(publisher.Enter()),
+          value_(publisher.current_.load()) {}
+
+    const SnapshotPublisher& publisher_;
+    size_t slot_;
+    const T* value_;
+  };
+
+  SnapshotPublisher() : current_(new T()) {}
+  SnapshotPublisher(const SnapshotPublisher&) = delete;
+  SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+  // Readers must be gone by now.
+  ~SnapshotPublisher() {
+    delete current_.load();
+    for (const auto& retired : retired_) delete retired.value;
+  }
+
+  // Any thread.
+  Reader Read() const { return Reader(*this); }
+
+  // Writer only.
+  void Publish(const T& value) {
+    PublishInPlace([&value](T& next) { next = value; });
+  }
+
+  // Writer only. fill overwrites a recycled version in place, saving a copy
+  // for large T. It must set every field.
+  template <typename Fill>
+  void PublishInPlace(Fill&& fill) {
+    std::unique_ptr<T> next;
+    if (free_.empty()) {
+      next = std::make_unique<T>();
+    } else {
+      next = std::move(free_.back());
+      free_.pop_back();
+    }
+    fill(*next);
+    T* previous = current_.exchange(next.release());
+    // readers that entered at or before this epoch may still hold previous
+    retired_.push_back({previous, epoch_.fetch_add(1)});
+    Reclaim();
+  }
+
+ private:
+  struct Retired {
+    T* value;
+    uint64_t epoch;
+  };
+
+  static constexpr uint64_t kIdle = 0;
+
+  size_t Enter() const {
+    for (;;) {
+      for (size_t slot = 0; slot < kMaxReaders; slot++) {
+        uint64_t idle = kIdle;
+        if (reader_epochs_[slot].load(std::memory_order_relaxed) == kIdle &&
+            reader_epochs_[slot].compare_exchange_strong(idle,
+                                                         epoch_.load())) {
+          return slot;
+        }
+      }
+      // every slot is pinned, wait for a reader to finish
+      std::this_thread::yield();
+    }
+  }
+
+  void Exit(const size_t slot) const { reader_epochs_[slot].store(kIdle); }
+
+  void Reclaim() {
+    uint64_t oldest_reader = UINT64_MAX;
+    for (const auto& reader_epoch : reader_epochs_) {
+      const uint64_t epoch = reader_epoch.load();
+      if (epoch != kIdle && epoch < oldest_reader) oldest_reader = epoch;
+    }
+    for (size_t i = 0; i < retired_.size();) {
+      if (retired_[i].epoch < oldest_reader) {
+        free_.emplace_back(retired_[i].value);
+        retired_[i] = retired_.back();
+        retired_.pop_back();
+      } else {
+        i++;
+      }
+    }
+  }
+
+  std::atomic<T*> current_;
+  // starts above kIdle so an active reader never advertises kIdle
+  std::atomic<uint64_t> epoch_{1};
+  mutable std::array<std::atomic<uint64_t>, kMaxReaders> reader_epochs_{};
+  // writer only
+  std::vector<Retired> retired_;
+  std::vector<std::unique_ptr<T>> free_;
+};
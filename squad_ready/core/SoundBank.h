@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SoundEvent.h"
+
+// What an event plays: the asset for key at gain. Events with the same key
+// play the same asset. An empty key plays nothing.
+struct SoundBinding {
+  std::string key;
+  float gain = 1.0f;
+
+  bool operator==(const SoundBinding& other) const = default;
+};
+
+using SoundBindings = std::array<SoundBinding, kSoundEvents>;
+
+// Maps every SoundEvent to a shared, loaded asset. Each distinct key is
+// loaded once however many events play it, and released once no event does,
+// so adding alerts that reuse a sound costs neither memory nor load time.
+template <typename Asset>
+class SoundBank {
+ public:
+  // Loads the asset for a key, may run on several threads at once.
+  using Loader = std::function<std::shared_ptr<Asset>(const std::string& key)>;
+
+  // Rebinds every event. Keys no event had before are loaded, in parallel if
+  // there are several.
+  void Bind(const SoundBindings& bindings, const Loader& load) {
+    std::vector<std::string> keys;
+    for (const auto& binding : bindings) {
+      if (binding.key.empty() || Find(binding.key) ||
+          std::ranges::find(keys, binding.key) != keys.end()) {
+        continue;
+      }
+      keys.push_back(binding.key);
+    }
+    const auto loaded = LoadAll(keys, load);
+
+    std::array<std::shared_ptr<Asset>, kSoundEvents> assets;
+    for (size_t i = 0; i < kSoundEvents; i++) {
+      const auto& key = bindings[i].key;
+      if (key.empty()) continue;
+      if (const auto index = Find(key)) {
+        assets[i] = slots_[*index].asset;
+      } else {
+        assets[i] = loaded[std::ranges::find(keys, key) - keys.begin()];
+      }
+    }
+    for (size_t i = 0; i < kSoundEvents; i++) {
+      slots_[i] = {bindings[i], std::move(assets[i])};
+    }
+  }
+
+  // Rebinds one event, loading its asset unless another event has it.
+  void Bind(const SoundEvent event, SoundBinding binding, const Loader& load) {
+    auto bindings = Bindings();
+    bindings[static_cast<size_t>(event)] = std::move(binding);
+    Bind(bindings, load);
+  }
+
+  // Loads key again, for every event playing it. For retrying a sound that
+  // failed to load, or picking up a changed file.
+  void Reload(const std::string& key, const Loader& load) {
+    if (key.empty()) return;
+    const auto asset = load(key);
+    for (auto& slot : slots_) {
+      if (slot.binding.key == key) slot.asset = asset;
+    }
+  }
+
+  void SetGain(const SoundEvent event, const float gain) {
+    slots_[static_cast<size_t>(event)].binding.gain = gain;
+  }
+
+  // Null if the event plays nothing.
+  Asset* Get(const SoundEvent event) const {
+    return slots_[static_cast<size_t>(event)].asset.get();
+  }
+  const SoundBinding& Binding(const SoundEvent event) const {
+    return slots_[static_cast<size_t>(event)].binding;
+  }
+  SoundBindings Bindings() const {
+    SoundBindings bindings;
+    for (size_t i = 0; i < kSoundEvents; i++) {
+      bindings[i] = slots_[i].binding;
+    }
+    return bindings;
+  }
+
+  // Calls f once for every distinct loaded asset.
+  template <typename F>
+  void ForEachAsset(F&& f) const {
+    for (size_t i = 0; i < kSoundEvents; i++) {
+      if (!slots_[i].asset) continue;
+      bool seen = false;
+      for (size_t j = 0; j < i && !seen; j++) {
+        seen = slots_[j].asset == slots_[i].asset;
+      }
+      if (!seen) f(slots_[i].binding.key, *slots_[i].asset);
+    }
+  }
+
+  void Clear() { slots_ = {}; }
+
+ private:
+  struct Slot {
+    SoundBinding binding;
+    std::shared_ptr<Asset> asset;
+  };
+
+  static std::vector<std::shared_ptr<Asset>> LoadAll(
+      const std::vector<std::string>& keys, const Loader& load) {
+    std::vector<std::shared_ptr<Asset>> assets(keys.size());
+    std::vector<std::future<void>> loading;
+    // the first key loads on this thread, the others alongside it
+    for (size_t i = 1; i < keys.size(); i++) {
+      loading.push_back(std::async(std::launch::async, [&, i] {
+        assets[i] = load(keys[i]);
+      }));
+    }
+    if (!keys.empty()) assets[0] = load(keys[0]);
+    for (auto& future : loading) future.get();
+    return assets;
+  }
+
+  std::optional<size_t> Find(const std::string& key) const {
+    for (size_t i = 0; i < kSoundEvents; i++) {
+      if (slots_[i].asset && slots_[i].binding.key == key) return i;
+    }
+    return std::nullopt;
+  }
+
+  std::array<Slot, kSoundEvents> slots_;
+};
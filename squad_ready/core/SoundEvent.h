@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Everything the tracker can play a sound for.
+enum class SoundEvent : uint8_t {
+  ReadyCheckStarted,
+  // the ready check sound again while self has not readied
+  ReadyCheckNag,
+  SquadReady,
+  // the check ended without everyone readying
+  ReadyCheckCancelled,
+  // someone joined a squad self was already in
+  MemberJoined,
+  // a subgroup became fully ready before the whole squad did
+  SubgroupReady,
+  Count,
+};
+
+constexpr size_t kSoundEvents = static_cast<size_t>(SoundEvent::Count);
+
+// Stable name, used as the settings key.
+constexpr const char* SoundEventId(const SoundEvent event) {
+  switch (event) {
+    case SoundEvent::ReadyCheckStarted:
+      return "ready_check";
+    case SoundEvent::ReadyCheckNag:
+      return "ready_check_nag";
+    case SoundEvent::SquadReady:
+      return "squad_ready";
+    case SoundEvent::ReadyCheckCancelled:
+      return "ready_check_cancelled";
+    case SoundEvent::MemberJoined:
+      return "member_joined";
+    case SoundEvent::SubgroupReady:
+      return "subgroup_ready";
+    default:
+      return "unknown";
+  }
+}
+
+// For display.
+constexpr const char* SoundEventName(const SoundEvent event) {
+  switch (event) {
+    case SoundEvent::ReadyCheckStarted:
+      return "ready check";
+    case SoundEvent::ReadyCheckNag:
+      return "ready check nag";
+    case SoundEvent::SquadReady:
+      return "squad ready";
+    case SoundEvent::ReadyCheckCancelled:
+      return "ready check cancelled";
+    case SoundEvent::MemberJoined:
+      return "member joined";
+    case SoundEvent::SubgroupReady:
+      return "subgroup ready";
+    default:
+      return "unknown";
+  }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+// How a custom sound file is held in memory once loaded.
+enum class SoundLoadMode : uint8_t {
+  // fully decoded to f32 PCM up front
+  Decode,
+  // decoded a page at a time into a small prefetched buffer while playing
+  Stream,
+};
+
+// What is known about a sound file before loading it, 0 for unknown.
+struct SoundFileInfo {
+  uint64_t file_size = 0;
+  uint64_t length_in_frames = 0;
+  uint32_t channels = 0;
+  uint32_t sample_rate = 0;
+};
+
+namespace sound_load_policy {
+
+// Short alerts are decoded so playback never touches the disk, anything
+// longer than this (voice lines, music) is streamed.
+constexpr double kMaxDecodedSeconds = 10.0;
+constexpr uint64_t kMaxDecodedBytes = 8ull << 20;
+// Used when the length cannot be determined without decoding.
+constexpr uint64_t kMaxDecodedFileSize = 2ull << 20;
+// miniaudio streams through two pages of one second each.
+constexpr uint64_t kStreamPages = 2;
+constexpr uint64_t kStreamPageMilliseconds = 1000;
+
+constexpr uint64_t DecodedBytes(const SoundFileInfo& info) {
+  return info.length_in_frames * info.channels * sizeof(float);
+}
+
+constexpr uint64_t StreamedBytes(const SoundFileInfo& info) {
+  return kStreamPages * info.sample_rate * kStreamPageMilliseconds / 1000 *
+         info.channels * sizeof(float);
+}
+
+constexpr SoundLoadMode Choose(const SoundFileInfo& info) {
+  if (info.length_in_frames == 0 || info.sample_rate == 0 ||
+      info.channels == 0) {
+    return info.file_size > kMaxDecodedFileSize ? SoundLoadMode::Stream
+                                                : SoundLoadMode::Decode;
+  }
+  const double seconds =
+      static_cast<double>(info.length_in_frames) / info.sample_rate;
+  if (seconds > kMaxDecodedSeconds || DecodedBytes(info) > kMaxDecodedBytes) {
+    return SoundLoadMode::Stream;
+  }
+  return SoundLoadMode::Decode;
+}
+
+}  // namespace sound_load_policy
@@ -0,0 +1,138 @@
+#include "SquadState.h"
+
+#include <algorithm>
+
+SquadTransition SquadState::ApplyBatch(const UserDelta* updated_users,
+                                       const size_t updated_users_count,
+                                       const std::string_view self_account_name,
+                                       const Clock::time_point now) {
+  // Apply the whole batch to the roster first and only note the edges it
+  // contained, so a bulk update (squad join, leader swap, subgroup shuffle)
+  // results in at most one transition.
+  SquadTransition transition;
+  const bool all_ready_before = players_.AllReady();
+  bool self_left = false;
+  bool leader_started = false;
+  bool leader_ended = false;
+  bool reached_all_ready = false;
+  uint16_t readied_subgroups = 0;
+
+  for (size_t i = 0; i < updated_users_count; i++) {
+    const auto& user = updated_users[i];
+    const auto user_account_name = user.AccountName();
+    // User added/updated
+    if (user.role != SquadRole::None) {
+      if (user_account_name == self_account_name) {
+        self_readied_ = user.ready;
+      }
+      bool inserted;
+      const int slot =
+          players_.FindOrInsert(user_account_name, user.hash, inserted);
+      if (slot == Roster::kNoSlot) {
+        transition.dropped_users++;
+        continue;
+      }
+      const bool old_ready = players_.Ready(slot);
+      // from the deltas rather than the roster masks, erasing a user may move
+      // another into a freed slot
+      if (Roster::Eligible(user.role) &&
+          (inserted ? user.join_time > forgotten_join_time_
+                    : !Roster::Eligible(players_.Role(slot)))) {
+        transition.joined_members++;
+      }
+      players_.Update(slot, user.join_time, user.role, user.subgroup,
+                      user.ready);
+
+      // Newly seen users don't signal anything, we may have just joined
+      if (inserted) continue;
+      if (user.ready && !old_ready) {
+        if (user.role == SquadRole::SquadLeader) {
+          // Squad leader has started a ready check
+          leader_started = true;
+        } else if (user.subgroup < Roster::kMaxSubgroups) {
+          readied_subgroups |= static_cast<uint16_t>(1u << user.subgroup);
+        }
+        // checked per user, as the squad may be reset later in the batch
+        if (players_.AllReady()) reached_all_ready = true;
+      } else if (!user.ready && old_ready &&
+                 user.role == SquadRole::SquadLeader) {
+        // Squad leader has ended a ready check, either via a complete
+        // ready check or by cancelling
+        leader_ended = true;
+      }
+    }
+    // User removed
+    else {
+      if (user_account_name == self_account_name) {
+        // Self left squad, reset cache
+        self_readied_ = false;
+        players_.Clear();
+        forgotten_join_time_ = std::numeric_limits<int64_t>::min();
+        self_left = true;
+      } else {
+        // Remove player from cache
+        players_.Erase(user_account_name, user.hash);
+      }
+    }
+  }
+
+  if (self_left) {
+    if (in_ready_check_) transition.event = SquadEvent::ReadyCheckEnded;
+  } else if (leader_started) {
+    transition.event = SquadEvent::ReadyCheckStarted;
+  } else if (reached_all_ready && !all_ready_before) {
+    transition.event = SquadEvent::ReadyCheckCompleted;
+  } else if (leader_ended) {
+    if (in_ready_check_) transition.event = SquadEvent::ReadyCheckEnded;
+  } else if (in_ready_check_) {
+    transition.readied_subgroups = NewlyReadiedSubgroups(readied_subgroups);
+  }
+
+  switch (transition.event) {
+    case SquadEvent::ReadyCheckStarted:
+      in_ready_check_ = true;
+      subgroups_readied_ = 0;
+      ready_check_start_time_ = now;
+      break;
+    case SquadEvent::ReadyCheckCompleted:
+    case SquadEvent::ReadyCheckEnded:
+      EndReadyCheck();
+      break;
+    default:
+      break;
+  }
+  return transition;
+}
+
+void SquadState::Forget() {
+  players_.ForEach([this](const int slot) {
+    forgotten_join_time_ =
+        std::max(forgotten_join_time_, players_.JoinTime(slot));
+  });
+  players_.Clear();
+  self_readied_ = false;
+  EndReadyCheck();
+}
+
+uint16_t SquadState::NewlyReadiedSubgroups(uint16_t candidates) {
+  uint16_t readied = 0;
+  for (size_t subgroup = 0; candidates != 0; subgroup++, candidates >>= 1) {
+    if ((candidates & 1) == 0) continue;
+    const uint16_t bit = static_cast<uint16_t>(1u << subgroup);
+    if (subgroups_readied_ & bit) continue;
+    if (!players_.SubgroupReady(subgroup)) continue;
+    // a single subgroup squad is covered by the squad ready event
+    const auto members =
+        players_.SubgroupMask(subgroup) & players_.EligibleMask();
+    if (members == players_.EligibleMask()) continue;
+    readied |= bit;
+  }
+  subgroups_readied_ |= readied;
+  return readied;
+}
+
+void SquadState::EndReadyCheck() {
+  in_ready_check_ = false;
+  subgroups_readied_ = 0;
+  ready_check_start_time_ = {};
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+#include "Roster.h"
+
+enum class SquadEvent : uint8_t {
+  None,
+  ReadyCheckStarted,
+  ReadyCheckCompleted,
+  ReadyCheckEnded,
+};
+
+// Outcome of applying one update batch.
+struct SquadTransition {
+  SquadEvent event = SquadEvent::None;
+  // bit per subgroup that became fully ready in this batch
+  uint16_t readied_subgroups = 0;
+  // users that did not fit in the roster
+  uint32_t dropped_users = 0;
+  // users that were added as, or promoted to, a squad member
+  uint32_t joined_members = 0;
+};
+
+// Roster plus the ready check state machine, without any side effects, so the
+// same logic drives the plugin and the offline trace replayer.
+class SquadState {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  SquadTransition ApplyBatch(const UserDelta* updated_users,
+                             size_t updated_users_count,
+                             std::string_view self_account_name,
+                             Clock::time_point now);
+
+  // Forgets the squad and any ready check, for when updates were lost. The
+  // squad fills in again from the updates that follow, and members who had
+  // joined by the time it was forgotten don't count as joining then.
+  void Forget();
+
+  const Roster& Players() const { return players_; }
+  bool InReadyCheck() const { return in_ready_check_; }
+  bool SelfReadied() const { return self_readied_; }
+  uint16_t SubgroupsReadied() const { return subgroups_readied_; }
+  Clock::time_point ReadyCheckStartTime() const {
+    return ready_check_start_time_;
+  }
+
+ private:
+  uint16_t NewlyReadiedSubgroups(uint16_t candidates);
+  void EndReadyCheck();
+
+  Roster players_;
+  Clock::time_point ready_check_start_time_;
+  bool in_ready_check_ = false;
+  // bit per subgroup that has already raised its ready event this check
+  uint16_t subgroups_readied_ = 0;
+  bool self_readied_ = false;
+  // latest join time in the roster when it was last forgotten
+  int64_t forgotten_join_time_ = std::numeric_limits<int64_t>::min();
+};
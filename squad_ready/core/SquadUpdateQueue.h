@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "Roster.h"
+#include "SpscQueue.h"
+
+// Carries squad update callbacks from the extras thread to the render thread.
+// A callback is queued whole or not at all, and handed to the consumer only
+// once all of its users have arrived.
+//
+// Callbacks are deltas, so one that doesn't fit can't just be dropped: the
+// roster would never hear of that leave, role change or ready flip. Dropping
+// one instead flags a resync, which the consumer picks up with TakeResync.
+class SquadUpdateQueue {
+ public:
+  // several full rosters, what a frame sees when joining a large squad
+  static constexpr size_t kCapacity = 256;
+  static_assert(kCapacity >= 4 * Roster::kCapacity);
+
+  // Producer only. Queues the users of one callback, make(i) returns the i-th
+  // as a UserDelta. False if it didn't fit and was dropped.
+  template <typename F>
+  bool Push(const size_t count, F&& make) {
+    if (count == 0) return true;
+    if (queue_.FreeSpace() < count) {
+      resync_needed_.store(true, std::memory_order_release);
+      return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+      UserDelta delta = make(i);
+      delta.batch_end = i + 1 == count;
+      queue_.TryPush(delta);
+    }
+    return true;
+  }
+
+  // Consumer only. True once for any number of callbacks dropped since the
+  // last call, the state built from the updates so far is out of date.
+  bool TakeResync() {
+    if (!resync_needed_.load(std::memory_order_relaxed)) return false;
+    return resync_needed_.exchange(false, std::memory_order_acquire);
+  }
+
+  // Consumer only. Calls apply(const UserDelta*, size_t) for every whole
+  // callback queued, in order. The users of a callback still being pushed
+  // wait for the rest until the next call.
+  template <typename F>
+  void Drain(F&& apply) {
+    while (queue_.TryPop(batch_[batch_size_])) {
+      if (batch_[batch_size_++].batch_end) {
+        apply(batch_.data(), batch_size_);
+        batch_size_ = 0;
+      }
+    }
+  }
+
+ private:
+  SpscQueue<UserDelta, kCapacity> queue_;
+  std::array<UserDelta, kCapacity> batch_;
+  // users of a callback popped before its batch_end was pushed
+  size_t batch_size_ = 0;
+  std::atomic<bool> resync_needed_ = false;
+};
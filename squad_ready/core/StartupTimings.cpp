@@ -0,0 +1,47 @@
+#include "StartupTimings.h"
+
+const char* StartupStageName(const StartupStage stage) {
+  switch (stage) {
+    case StartupStage::Exports:
+      return "exports";
+    case StartupStage::Settings:
+      return "settings";
+    case StartupStage::AudioContext:
+      return "audio context";
+    case StartupStage::DeviceEnumeration:
+      return "device enumeration";
+    case StartupStage::AudioEngine:
+      return "audio engine";
+    case StartupStage::Sounds:
+      return "sounds";
+    case StartupStage::UpdateCheck:
+      return "update check";
+    default:
+      return "unknown";
+  }
+}
+
+void StartupTimings::Record(const StartupStage stage,
+                            const Clock::time_point start,
+                            const Clock::time_point end,
+                            const bool succeeded) {
+  auto& slot = slots_[static_cast<size_t>(stage)];
+  slot.start =
+      std::chrono::duration_cast<std::chrono::microseconds>(start - origin_);
+  slot.duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  // publishes start/duration to readers that see the status
+  slot.status.store(succeeded ? Status::Succeeded : Status::Failed,
+                    std::memory_order_release);
+}
+
+StartupTimings::Entry StartupTimings::Get(const StartupStage stage) const {
+  const auto& slot = slots_[static_cast<size_t>(stage)];
+  Entry entry;
+  entry.status = slot.status.load(std::memory_order_acquire);
+  if (entry.status != Status::Pending) {
+    entry.start = slot.start;
+    entry.duration = slot.duration;
+  }
+  return entry;
+}
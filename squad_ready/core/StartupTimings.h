@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+enum class StartupStage : uint8_t {
+  // mod_init itself, ie. what arcdps waits on
+  Exports,
+  Settings,
+  AudioContext,
+  DeviceEnumeration,
+  AudioEngine,
+  Sounds,
+  UpdateCheck,
+  Count,
+};
+
+const char* StartupStageName(StartupStage stage);
+
+// When each startup stage ran and how long it took, relative to the start of
+// mod_init. Stages are recorded from whichever thread runs them and can be
+// read from any thread.
+class StartupTimings {
+ public:
+  using Clock = std::chrono::steady_clock;
+  static constexpr size_t kStages = static_cast<size_t>(StartupStage::Count);
+
+  enum class Status : uint8_t { Pending, Succeeded, Failed };
+
+  struct Entry {
+    Status status = Status::Pending;
+    std::chrono::microseconds start{};
+    std::chrono::microseconds duration{};
+  };
+
+  explicit StartupTimings(Clock::time_point origin = Clock::now())
+      : origin_(origin) {}
+
+  // Runs f, which returns whether the stage succeeded, and records it.
+  template <typename F>
+  bool Measure(const StartupStage stage, F&& f) {
+    const auto start = Clock::now();
+    const bool succeeded = f();
+    Record(stage, start, Clock::now(), succeeded);
+    return succeeded;
+  }
+
+  Clock::time_point Origin() const { return origin_; }
+  void Record(StartupStage stage, Clock::time_point start,
+              Clock::time_point end, bool succeeded);
+  Entry Get(StartupStage stage) const;
+  bool Done(const StartupStage stage) const {
+    return Get(stage).status != Status::Pending;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<Status> status{Status::Pending};
+    std::chrono::microseconds start{};
+    std::chrono::microseconds duration{};
+  };
+
+  Clock::time_point origin_;
+  std::array<Slot, kStages> slots_;
+};
@@ -0,0 +1,175 @@
+#include "Trace.h"
+
+#include <algorithm>
+
+namespace trace {
+
+namespace {
+constexpr char kMagic[4] = {'S', 'R', 'T', 'R'};
+constexpr size_t kMaxNameLength = 255;
+constexpr size_t kMaxUsersPerUpdate = 0xFFFF;
+}  // namespace
+
+bool Writer::Open(const std::string& path) {
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_.is_open()) return false;
+  file_.write(kMagic, sizeof(kMagic));
+  WriteInt<uint16_t>(kVersion);
+  WriteInt<uint16_t>(0);
+  return file_.good();
+}
+
+void Writer::Close() {
+  if (file_.is_open()) file_.close();
+}
+
+void Writer::WriteSelfAccount(const uint64_t timestamp_us,
+                              const std::string_view account_name) {
+  WriteInt(static_cast<uint8_t>(RecordType::SelfAccount));
+  WriteInt(timestamp_us);
+  WriteName(account_name);
+}
+
+void Writer::WriteSquadUpdate(const uint64_t timestamp_us, const User* users,
+                              size_t user_count) {
+  user_count = std::min(user_count, kMaxUsersPerUpdate);
+  WriteInt(static_cast<uint8_t>(RecordType::SquadUpdate));
+  WriteInt(timestamp_us);
+  WriteInt(static_cast<uint16_t>(user_count));
+  for (size_t i = 0; i < user_count; i++) {
+    WriteName(users[i].account_name);
+    WriteInt(users[i].join_time);
+    WriteInt(users[i].role);
+    WriteInt(users[i].subgroup);
+    WriteInt(static_cast<uint8_t>(users[i].ready));
+  }
+}
+
+void Writer::WriteName(std::string_view name) {
+  name = name.substr(0, std::min(name.size(), kMaxNameLength));
+  WriteInt(static_cast<uint8_t>(name.size()));
+  file_.write(name.data(), static_cast<std::streamsize>(name.size()));
+}
+
+template <typename T>
+void Writer::WriteInt(const T value) {
+  char bytes[sizeof(T)];
+  for (size_t i = 0; i < sizeof(T); i++) {
+    bytes[i] = static_cast<char>(static_cast<uint64_t>(value) >> (8 * i));
+  }
+  file_.write(bytes, sizeof(T));
+}
+
+bool Reader::Open(const std::string& path) {
+  file_.open(path, std::ios::binary);
+  if (!file_.is_open()) {
+    error_ = "failed to open trace";
+    return false;
+  }
+  char magic[sizeof(kMagic)];
+  uint16_t version, reserved;
+  if (!file_.read(magic, sizeof(magic)) ||
+      !std::equal(magic, magic + sizeof(magic), kMagic) ||
+      !ReadInt(version) || !ReadInt(reserved)) {
+    error_ = "not a squad ready trace";
+    return false;
+  }
+  if (version != kVersion) {
+    error_ = "unsupported trace version " + std::to_string(version);
+    return false;
+  }
+  return true;
+}
+
+bool Reader::Next(Record& record) {
+  uint8_t type;
+  if (!ReadInt(type)) return false;  // clean end of trace
+
+  record.type = static_cast<RecordType>(type);
+  record.self_account_name.clear();
+  record.users.clear();
+  if (!ReadInt(record.timestamp_us)) {
+    error_ = "truncated record";
+    return false;
+  }
+  switch (record.type) {
+    case RecordType::SelfAccount:
+      if (!ReadName(record.self_account_name)) {
+        error_ = "truncated self account record";
+        return false;
+      }
+      return true;
+    case RecordType::SquadUpdate: {
+      uint16_t user_count;
+      if (!ReadInt(user_count)) {
+        error_ = "truncated squad update record";
+        return false;
+      }
+      record.users.resize(user_count);
+      for (auto& user : record.users) {
+        uint8_t ready;
+        if (!ReadName(user.account_name) || !ReadInt(user.join_time) ||
+            !ReadInt(user.role) || !ReadInt(user.subgroup) ||
+            !ReadInt(ready)) {
+          error_ = "truncated squad update record";
+          return false;
+        }
+        user.ready = ready != 0;
+      }
+      return true;
+    }
+  }
+  error_ = "unknown record type " + std::to_string(type);
+  return false;
+}
+
+bool Reader::ReadName(std::string& name) {
+  uint8_t length;
+  if (!ReadInt(length)) return false;
+  name.resize(length);
+  return static_cast<bool>(file_.read(name.data(), length));
+}
+
+template <typename T>
+bool Reader::ReadInt(T& value) {
+  unsigned char bytes[sizeof(T)];
+  if (!file_.read(reinterpret_cast<char*>(bytes), sizeof(T))) return false;
+  uint64_t result = 0;
+  for (size_t i = 0; i < sizeof(T); i++) {
+    result |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+  }
+  value = static_cast<T>(result);
+  return true;
+}
+
+bool Recorder::Start(const std::string& path,
+                     const std::string_view self_account_name) {
+  std::scoped_lock guard(mutex_);
+  if (recording_.load(std::memory_order_relaxed)) return true;
+  if (!writer_.Open(path)) return false;
+  path_ = path;
+  start_ = std::chrono::steady_clock::now();
+  writer_.WriteSelfAccount(0, self_account_name);
+  recording_.store(true, std::memory_order_release);
+  return true;
+}
+
+void Recorder::Stop() {
+  std::scoped_lock guard(mutex_);
+  recording_.store(false, std::memory_order_release);
+  writer_.Close();
+}
+
+void Recorder::RecordSquadUpdate(const User* users, const size_t user_count) {
+  std::scoped_lock guard(mutex_);
+  if (!writer_.IsOpen()) return;
+  writer_.WriteSquadUpdate(Now(), users, user_count);
+}
+
+uint64_t Recorder::Now() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start_)
+      .count();
+}
+
+}  // namespace trace
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Compact binary trace of unofficial extras squad updates, used to reproduce
+// squad behaviour offline with the squad_ready_replay tool.
+//
+// Layout, all integers little endian:
+//   header:  "SRTR" u16 version u16 reserved
+//   record:  u8 type, u64 timestamp (microseconds since recording started)
+//     SelfAccount: u8 name length, name
+//     SquadUpdate: u16 user count, then per user
+//                  u8 name length, name, i64 join time, u8 role,
+//                  u8 subgroup, u8 ready
+namespace trace {
+
+constexpr uint16_t kVersion = 1;
+
+enum class RecordType : uint8_t {
+  SelfAccount = 1,
+  SquadUpdate = 2,
+};
+
+// Mirrors the fields of UserInfo that the tracker consumes.
+struct User {
+  std::string account_name;
+  int64_t join_time = 0;
+  uint8_t role = 0;
+  uint8_t subgroup = 0;
+  bool ready = false;
+};
+
+struct Record {
+  RecordType type = RecordType::SelfAccount;
+  uint64_t timestamp_us = 0;
+  std::string self_account_name;
+  std::vector<User> users;
+};
+
+class Writer {
+ public:
+  bool Open(const std::string& path);
+  void Close();
+  bool IsOpen() const { return file_.is_open(); }
+
+  void WriteSelfAccount(uint64_t timestamp_us, std::string_view account_name);
+  void WriteSquadUpdate(uint64_t timestamp_us, const User* users,
+                        size_t user_count);
+
+ private:
+  void WriteName(std::string_view name);
+  template <typename T>
+  void WriteInt(T value);
+
+  std::ofstream file_;
+};
+
+class Reader {
+ public:
+  bool Open(const std::string& path);
+  // Returns false at the end of the trace or on a malformed record, check
+  // Error() to tell them apart.
+  bool Next(Record& record);
+  const std::string& Error() const { return error_; }
+
+ private:
+  bool ReadName(std::string& name);
+  template <typename T>
+  bool ReadInt(T& value);
+
+  std::ifstream file_;
+  std::string error_;
+};
+
+// Thread safe recorder, toggled from the debug window while squad updates
+// arrive on the unofficial extras thread. Costs one atomic load per callback
+// while not recording.
+class Recorder {
+ public:
+  bool Start(const std::string& path, std::string_view self_account_name);
+  void Stop();
+  bool IsRecording() const {
+    return recording_.load(std::memory_order_acquire);
+  }
+  void RecordSquadUpdate(const User* users, size_t user_count);
+  const std::string& Path() const { return path_; }
+
+ private:
+  uint64_t Now() const;
+
+  std::mutex mutex_;
+  std::atomic<bool> recording_ = false;
+  Writer writer_;
+  std::string path_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace trace
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Picks which of a fixed set of preallocated voices plays the next trigger of
+// a sound, so a retrigger overlaps the instance still playing instead of
+// being dropped. When every voice is busy the one that started longest ago is
+// stolen and restarted. Nothing here allocates.
+template <size_t Capacity>
+class VoicePool {
+ public:
+  static constexpr size_t kCapacity = Capacity;
+
+  explicit VoicePool(const size_t voices = Capacity)
+      : voices_(std::clamp<size_t>(voices, 1, Capacity)) {}
+
+  size_t Voices() const { return voices_; }
+  uint64_t Steals() const { return steals_; }
+
+  // Returns the voice to (re)start. is_playing(i) reports whether voice i is
+  // still sounding.
+  template <typename IsPlaying>
+  size_t Acquire(IsPlaying&& is_playing) {
+    size_t oldest = 0;
+    for (size_t i = 0; i < voices_; i++) {
+      if (!is_playing(i)) return Start(i);
+      if (started_[i] < started_[oldest]) oldest = i;
+    }
+    steals_++;
+    return Start(oldest);
+  }
+
+ private:
+  size_t Start(const size_t voice) {
+    started_[voice] = ++sequence_;
+    return voice;
+  }
+
+  size_t voices_;
+  std::array<uint64_t, Capacity> started_{};
+  uint64_t sequence_ = 0;
+  uint64_t steals_ = 0;
+};
+
+// Time from a sound being triggered to the audio thread first reading its
+// frames, which is when it enters the mix. Triggered on one thread and
+// recorded from the audio thread, so everything is atomic.
+class TriggerLatency {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Stats {
+    uint64_t count = 0;
+    std::chrono::microseconds last{0};
+    std::chrono::microseconds max{0};
+    std::chrono::microseconds mean{0};
+  };
+
+  static int64_t Now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               Clock::now().time_since_epoch())
+        .count();
+  }
+
+  void Record(const int64_t triggered_at) {
+    const uint64_t latency = std::max<int64_t>(Now() - triggered_at, 0);
+    last_.store(latency, std::memory_order_relaxed);
+    total_.fetch_add(latency, std::memory_order_relaxed);
+    auto max = max_.load(std::memory_order_relaxed);
+    while (latency > max && !max_.compare_exchange_weak(
+                                max, latency, std::memory_order_relaxed)) {
+    }
+    count_.fetch_add(1, std::memory_order_release);
+  }
+
+  Stats Get() const {
+    Stats stats;
+    stats.count = count_.load(std::memory_order_acquire);
+    if (stats.count == 0) return stats;
+    stats.last = std::chrono::microseconds(last_.load());
+    stats.max = std::chrono::microseconds(max_.load());
+    stats.mean = std::chrono::microseconds(total_.load() / stats.count);
+    return stats;
+  }
+
+ private:
+  std::atomic<uint64_t> count_ = 0;
+  std::atomic<uint64_t> last_ = 0;
+  std::atomic<uint64_t> max_ = 0;
+  std::atomic<uint64_t> total_ = 0;
+};
@@ -5,11 +5,13 @@
 #include <map>
 
 #include "Audio.h"
+#include "AudioSettings.h"
 #include "Globals.h"
 #include "Logging.h"
 #include "Settings.h"
 #include "SettingsUI.h"
 #include "SquadTracker.h"
+#include "Startup.h"
 #include "extension/KeyBindHandler.h"
 #include "extension/KeyInput.h"
 #include "extension/Singleton.h"
@@ -65,6 +67,7 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ulReasonForCall,
  * processed by arcdps or game) */
 uintptr_t mod_wnd(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
   try {
+    const ScopedTimer timer(globals::metrics, Metric::WindowMessage);
     globals::some_window = hWnd;
 
     if (ImGuiEx::KeyCodeInputWndHandle(hWnd, uMsg, wParam, lParam)) {
@@ -136,15 +139,23 @@ uintptr_t mod_windows(const char* windowname) {
 }
 
 uintptr_t mod_imgui(uint32_t not_charsel_or_loading) {
+  globals::metrics.EndFrame();
+  const ScopedTimer timer(globals::metrics, Metric::Frame);
+  if (startup::AudioReady()) {
+    AudioPlayer::instance([](AudioPlayer& i) { i.Update(); });
+  }
   if (squad_tracker) {
-    squad_tracker->Tick();
+    squad_tracker->ProcessQueuedUsers();
+    squad_tracker->Tick(not_charsel_or_loading);
     squad_tracker->Draw();
   }
-  UpdateChecker::instance([](auto i) {
-    i.Draw(
-        globals::update_state, kSquadReadyPluginName,
-        "https://github.com/cheahjs/arcdps-squad-ready-plugin/releases/latest");
-  });
+  if (startup::UpdateCheckDone()) {
+    UpdateChecker::instance([](auto i) {
+      i.Draw(
+          globals::update_state, kSquadReadyPluginName,
+          "https://github.com/cheahjs/arcdps-squad-ready-plugin/releases/latest");
+    });
+  }
 
   return 0;
 }
@@ -152,6 +163,8 @@ uintptr_t mod_imgui(uint32_t not_charsel_or_loading) {
 /* initialize mod -- return table that arcdps will use for callbacks. exports
  * struct and strings are copied to arcdps memory only once at init */
 arcdps_exports* mod_init() {
+  logging::Start();
+  startup::Begin();
   bool loading_successful = true;
   std::string error_message = "Unknown error";
 
@@ -159,23 +172,19 @@ arcdps_exports* mod_init() {
       UpdateChecker::instance().GetCurrentVersion(globals::self_dll);
 
   try {
-    UpdateChecker::instance().ClearFiles(globals::self_dll);
-
-    if (current_version) {
-      globals::update_state =
-          std::move(UpdateChecker::instance().CheckForUpdate(
-              globals::self_dll, current_version.value(),
-              "cheahjs/arcdps-squad-ready-plugin", false));
-    }
+    // only construct here, loading happens in startup::Start's workers
     SettingsUI::instance(std::make_unique<SettingsUI>());
-    Settings::instance(std::make_unique<Settings>()).load();
-    AudioPlayer::instance(std::make_unique<AudioPlayer>())
-        .Init(
-        Settings::instance().settings.ready_check_path.value_or(""),
-        Settings::instance().settings.ready_check_volume,
-        Settings::instance().settings.squad_ready_path.value_or(""),
-        Settings::instance().settings.squad_ready_volume,
-        Settings::instance().settings.audio_output_device);
+    auto& settings = Settings::instance(std::make_unique<Settings>());
+    AudioPlayer::instance(std::make_unique<AudioPlayer>(globals::metrics));
+    // the options panel only changes settings once startup::Ready()
+    settings.Subscribe([](const Settings::SettingsObject&,
+                          const Settings::SettingsObject& current) {
+      logging::SetDebugEnabled(current.debug_logging);
+      const auto config = ResolveAudioConfig(current);
+      AudioPlayer::instance([&](AudioPlayer& audio_player) {
+        audio_player.ApplyConfig(config);
+      });
+    });
     squad_tracker = std::make_unique<SquadTracker>();
   } catch (const std::exception& e) {
     loading_successful = false;
@@ -211,6 +220,8 @@ arcdps_exports* mod_init() {
     arc_exports.size = reinterpret_cast<uintptr_t>(buffer);
   }
 
+  if (loading_successful) startup::Start(current_version);
+
   logging::Debug("done mod_init");
   return &arc_exports;
 }
@@ -218,6 +229,7 @@ arcdps_exports* mod_init() {
 /* release mod -- return ignored */
 uintptr_t mod_release() {
   logging::Squad("Shutting down");
+  startup::Wait();
   if (globals::update_state) {
     globals::update_state->FinishPendingTasks();
     globals::update_state.reset(nullptr);
@@ -229,6 +241,7 @@ uintptr_t mod_release() {
 
   squad_tracker.reset();
   logging::Squad("Shutdown complete");
+  logging::Stop();
   return 0;
 }
 
@@ -280,7 +293,7 @@ void squad_update_callback(const UserInfo* updatedUsers,
                            size_t updatedUsersCount) {
   if (init_failed) return;
   if (!squad_tracker) return;
-  squad_tracker->UpdateUsers(updatedUsers, updatedUsersCount);
+  squad_tracker->QueueUsers(updatedUsers, updatedUsersCount);
 }
 
 extern "C" __declspec(dllexport) void arcdps_unofficial_extras_subscriber_init(
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Roster.h"
+
+namespace test {
+
+inline UserDelta User(const std::string& name, const SquadRole role,
+                      const uint8_t subgroup = 0, const bool ready = false) {
+  return UserDelta::Make(name.c_str(), 0, role, subgroup, ready);
+}
+
+inline UserDelta Left(const std::string& name) {
+  return User(name, SquadRole::None);
+}
+
+// Two account names that hash to the same roster slot, so the second one is
+// probed past the first.
+inline std::pair<std::string, std::string> CollidingNames() {
+  const auto home = [](const std::string& name) {
+    return Roster::HashAccountName(name) & (Roster::kCapacity - 1);
+  };
+  const std::string first = "Colliding.1000";
+  for (int i = 1001;; i++) {
+    auto second = "Colliding." + std::to_string(i);
+    if (home(second) == home(first)) return {first, std::move(second)};
+  }
+}
+
+}  // namespace test
@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "Audio.h"
+#include "ReadyCheckTracker.h"
+#include "TestSquad.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr uint32_t kChannels = 2;
+constexpr uint32_t kSampleRate = 48000;
+// one offline output block
+constexpr auto kStep = 10ms;
+// anything quieter is silence
+constexpr float kSilence = 1e-4f;
+
+const std::string kReadyCheckPath =
+    std::string(SQUAD_READY_SOUNDS_DIR) + "/ready_check.wav";
+const std::string kSquadReadyPath =
+    std::string(SQUAD_READY_SOUNDS_DIR) + "/squad_ready.wav";
+
+size_t Frames(const std::chrono::nanoseconds time) {
+  return static_cast<size_t>(time.count() * kSampleRate / 1'000'000'000);
+}
+
+// Runs AudioPlayer headless into an offline output and keeps everything it
+// rendered, so tests can tell which sounds played, when, and how loud.
+class AudioPlayerTest : public testing::Test {
+ protected:
+  AudioPlayerTest()
+      : player_(metrics_,
+                {.pcm_cache_path = {},
+                 .headless = true,
+                 .rendered = [this](const float* frames,
+                                    const uint32_t frame_count) {
+                   output_.insert(output_.end(), frames,
+                                  frames + frame_count * kChannels);
+                 }}) {}
+
+  void SetUp() override {
+    AudioConfig config;
+    Bind(config, SoundEvent::ReadyCheckStarted, kReadyCheckPath, 1.0f);
+    Bind(config, SoundEvent::ReadyCheckNag, kReadyCheckPath, 0.25f);
+    Bind(config, SoundEvent::SquadReady, kSquadReadyPath, 0.5f);
+    config.output_device = AudioDevices::kNoOutput;
+    // so the output level is just the gain
+    config.normalize_volume = false;
+    ASSERT_TRUE(player_.Init(config));
+  }
+
+  static void Bind(AudioConfig& config, const SoundEvent event,
+                   const std::string& path, const float gain) {
+    config.bindings[static_cast<size_t>(event)] = {path, gain};
+  }
+
+  std::chrono::nanoseconds Now() const {
+    return std::chrono::nanoseconds(
+        static_cast<int64_t>(FramesRendered()) * 1'000'000'000 / kSampleRate);
+  }
+  size_t FramesRendered() const { return output_.size() / kChannels; }
+
+  void Advance(const std::chrono::nanoseconds duration) {
+    for (auto left = duration; left > 0ns; left -= kStep) {
+      player_.Advance(std::min<std::chrono::nanoseconds>(left, kStep));
+    }
+  }
+
+  // Loudest sample between the two times.
+  float Peak(const std::chrono::nanoseconds from,
+             const std::chrono::nanoseconds to) const {
+    const auto begin = std::min(Frames(from), FramesRendered()) * kChannels;
+    const auto end = std::min(Frames(to), FramesRendered()) * kChannels;
+    float peak = 0.0f;
+    for (size_t i = begin; i < end; i++) {
+      peak = std::max(peak, std::abs(output_[i]));
+    }
+    return peak;
+  }
+
+  // When sound is first heard at or after from, -1ns if it never is.
+  std::chrono::nanoseconds Onset(const std::chrono::nanoseconds from) const {
+    for (size_t frame = Frames(from); frame < FramesRendered(); frame++) {
+      for (uint32_t channel = 0; channel < kChannels; channel++) {
+        if (std::abs(output_[frame * kChannels + channel]) > kSilence) {
+          return std::chrono::nanoseconds(static_cast<int64_t>(frame) *
+                                          1'000'000'000 / kSampleRate);
+        }
+      }
+    }
+    return -1ns;
+  }
+
+  Metrics metrics_;
+  std::vector<float> output_;
+  AudioPlayer player_;
+};
+
+TEST_F(AudioPlayerTest, LoadsBoundSounds) {
+  EXPECT_TRUE(player_.EngineReady());
+  EXPECT_EQ(player_.SoundStatus(SoundEvent::ReadyCheckStarted), "");
+  EXPECT_EQ(player_.SoundStatus(SoundEvent::SquadReady), "");
+  EXPECT_EQ(player_.OutputDeviceName(), AudioDevices::kNoOutput);
+}
+
+TEST_F(AudioPlayerTest, SilentUntilPlayed) {
+  Advance(500ms);
+  EXPECT_EQ(FramesRendered(), Frames(500ms));
+  EXPECT_EQ(Peak(0ns, 500ms), 0.0f);
+}
+
+TEST_F(AudioPlayerTest, PlaysFromTheNextBlock) {
+  Advance(200ms);
+  player_.Play(SoundEvent::ReadyCheckStarted);
+  Advance(2s);
+  // leading silence is trimmed, so it is heard right away
+  const auto onset = Onset(0ns);
+  EXPECT_GE(onset, 200ms);
+  EXPECT_LT(onset, 200ms + kStep);
+  // and finishes
+  EXPECT_EQ(Peak(1900ms, 2200ms), 0.0f);
+}
+
+TEST_F(AudioPlayerTest, PlaysAtTheEventsGain) {
+  player_.Play(SoundEvent::ReadyCheckStarted);
+  Advance(2s);
+  // the nag plays the same sound at a quarter of the gain
+  player_.Play(SoundEvent::ReadyCheckNag);
+  Advance(2s);
+  const float full = Peak(0s, 2s);
+  const float nag = Peak(2s, 4s);
+  ASSERT_GT(full, 0.05f);
+  EXPECT_NEAR(nag / full, 0.25f, 0.01f);
+}
+
+TEST_F(AudioPlayerTest, UnboundEventPlaysNothing) {
+  player_.Play(SoundEvent::MemberJoined);
+  Advance(1s);
+  EXPECT_EQ(Peak(0s, 1s), 0.0f);
+}
+
+TEST_F(AudioPlayerTest, NewBindingsApplyWithoutReload) {
+  AudioConfig config;
+  Bind(config, SoundEvent::ReadyCheckStarted, kReadyCheckPath, 0.5f);
+  config.output_device = AudioDevices::kNoOutput;
+  config.normalize_volume = false;
+  player_.Play(SoundEvent::ReadyCheckStarted);
+  Advance(2s);
+  player_.ApplyConfig(config);
+  player_.Play(SoundEvent::ReadyCheckStarted);
+  Advance(2s);
+  EXPECT_NEAR(Peak(2s, 4s) / Peak(0s, 2s), 0.5f, 0.01f);
+  // nothing else is bound now
+  player_.Play(SoundEvent::SquadReady);
+  Advance(1s);
+  EXPECT_EQ(Peak(4s, 5s), 0.0f);
+}
+
+// Plays the tracker's alerts through the player.
+class PlayerSink final : public AudioSink, public WindowSink {
+ public:
+  explicit PlayerSink(AudioPlayer& player) : player_(player) {}
+  void Play(const SoundEvent event) override { player_.Play(event); }
+  void FlashWindow() override {}
+
+ private:
+  AudioPlayer& player_;
+};
+
+TEST_F(AudioPlayerTest, ReadyCheckAlertsPlayOnTheSimulatedClock) {
+  PlayerSink sink(player_);
+  SimulatedClock clock;
+  ReadyCheckTracker tracker(sink, sink, clock);
+  tracker.SetConfig({.flash_window = false,
+                     .ready_check_nag = true,
+                     .ready_check_nag_interval_seconds = 3.0f});
+  const auto origin = ClockSink::Clock::time_point{} + 1h;
+  // the tracker's clock follows the audio rendered so far
+  const auto step = [&](const std::chrono::nanoseconds duration) {
+    const auto until = Now() + duration;
+    while (Now() < until) {
+      clock.Set(origin + Now());
+      if (clock.Now() >= tracker.NextDeadline()) tracker.Tick();
+      Advance(kStep);
+    }
+  };
+  const auto apply = [&](std::initializer_list<UserDelta> users) {
+    clock.Set(origin + Now());
+    const std::vector<UserDelta> batch(users);
+    tracker.ApplyBatch(batch.data(), batch.size(), "Self.1234");
+  };
+
+  apply({test::User("Self.1234", SquadRole::Member),
+         test::User("Leader.1", SquadRole::SquadLeader)});
+  step(1s);
+  EXPECT_EQ(Peak(0s, 1s), 0.0f);
+
+  // started at 1s, nagged at 4s until self readies
+  apply({test::User("Leader.1", SquadRole::SquadLeader, 0, true)});
+  step(5s);
+  const auto started = Onset(1s);
+  EXPECT_GE(started, 1s);
+  EXPECT_LT(started, 1s + kStep);
+  EXPECT_EQ(Peak(2900ms, 4s), 0.0f);
+  const auto nagged = Onset(4s);
+  EXPECT_GE(nagged, 4s);
+  EXPECT_LT(nagged, 4s + 2 * kStep);
+  EXPECT_NEAR(Peak(4s, 6s) / Peak(1s, 3s), 0.25f, 0.01f);
+
+  // everyone ready, at the squad ready gain
+  apply({test::User("Self.1234", SquadRole::Member, 0, true)});
+  step(2s);
+  const auto completed = Onset(6s);
+  EXPECT_GE(completed, 6s);
+  EXPECT_LT(completed, 6s + kStep);
+}
+
+}  // namespace
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "OptionsView.h"
+#include "ReadyCheckTracker.h"
+#include "TestSquad.h"
+
+namespace {
+
+using test::User;
+
+// Answers like a player with every sound loaded, with strings too long for
+// the small string buffer so any copy allocates.
+class FakeAudio final : public AudioStatusSource {
+ public:
+  std::string SoundStatus(const SoundEvent event) override {
+    calls++;
+    return event == SoundEvent::MemberJoined ? "Failed to open the file"
+                                             : "";
+  }
+  std::string SoundMemory(SoundEvent) override {
+    calls++;
+    return "decoded, 1.2 MiB in memory";
+  }
+  std::string SoundLevels(const SoundEvent event) override {
+    calls++;
+    return event == SoundEvent::SquadReady ? ""
+                                           : "trimmed 12ms, gain -3.5dB";
+  }
+  std::vector<std::string> OutputDevices() override {
+    calls++;
+    return {"Default", "No output", "Speakers (High Definition Audio)"};
+  }
+  std::string OutputDeviceName() override {
+    calls++;
+    return "Speakers (High Definition Audio)";
+  }
+
+  int calls = 0;
+};
+
+class NoSinks final : public AudioSink, public WindowSink {
+ public:
+  void Play(SoundEvent) override {}
+  void FlashWindow() override {}
+};
+
+class OptionsViewTest : public testing::Test {
+ protected:
+  OptionsViewTest() {
+    paths_[static_cast<size_t>(SoundEvent::ReadyCheckStarted)] =
+        "C:\\Users\\Player\\Music\\a rather long ready check sound.wav";
+    const std::vector<UserDelta> squad = {
+        User("Self.1234", SquadRole::Member),
+        User("Leader.1", SquadRole::SquadLeader, 0, true),
+        User("Member.1", SquadRole::Member, 1, true)};
+    tracker_.ApplyBatch(squad.data(), squad.size(), "Self.1234");
+  }
+
+  // The part of SettingsUI::Draw that isn't ImGui calls: bring the view up to
+  // date, line the path fields up with the settings and read the squad
+  // status. Returns whether the view was rebuilt.
+  bool Frame() {
+    bool rebuilt = false;
+    if (view_.OutOfDate(settings_version_, audio_version_)) {
+      view_.Rebuild(settings_version_, audio_version_, output_device_,
+                    audio_);
+      rebuilt = true;
+    }
+    for (size_t i = 0; i < kSoundEvents; i++) edits_[i].Sync(paths_[i]);
+    const auto snapshot = tracker_.Snapshot();
+    const auto& players = snapshot->players;
+    ready_ = std::popcount(players.EligibleMask() & players.ReadyMask());
+    return rebuilt;
+  }
+
+  FakeAudio audio_;
+  uint64_t audio_version_ = 1;
+  uint64_t settings_version_ = 1;
+  std::optional<std::string> output_device_ =
+      "Speakers (High Definition Audio)";
+  std::array<std::optional<std::string>, kSoundEvents> paths_;
+
+  OptionsView view_;
+  std::array<PathEdit, kSoundEvents> edits_;
+  NoSinks sinks_;
+  SimulatedClock clock_;
+  ReadyCheckTracker tracker_{sinks_, sinks_, clock_};
+  int ready_ = 0;
+};
+
+TEST_F(OptionsViewTest, BuildsTheView) {
+  EXPECT_TRUE(Frame());
+  EXPECT_EQ(view_.Of(SoundEvent::ReadyCheckStarted).details,
+            "(decoded, 1.2 MiB in memory, trimmed 12ms, gain -3.5dB)");
+  EXPECT_EQ(view_.Of(SoundEvent::SquadReady).details,
+            "(decoded, 1.2 MiB in memory)");
+  EXPECT_EQ(view_.Of(SoundEvent::MemberJoined).error,
+            "Failed to open the file");
+  EXPECT_TRUE(view_.Of(SoundEvent::MemberJoined).details.empty());
+  EXPECT_EQ(view_.devices.size(), 3u);
+  EXPECT_EQ(view_.selected_device, "Speakers (High Definition Audio)");
+  EXPECT_EQ(edits_[0].buffer, *paths_[0]);
+  EXPECT_EQ(ready_, 2);
+
+  output_device_.reset();
+  settings_version_++;
+  EXPECT_TRUE(Frame());
+  EXPECT_EQ(view_.selected_device, "Default");
+}
+
+TEST_F(OptionsViewTest, RebuildsOnlyWhenAVersionChanges) {
+  Frame();
+  const int calls = audio_.calls;
+  EXPECT_FALSE(Frame());
+  EXPECT_EQ(audio_.calls, calls);
+
+  audio_version_++;
+  EXPECT_TRUE(Frame());
+  EXPECT_GT(audio_.calls, calls);
+}
+
+TEST_F(OptionsViewTest, KeepsAFieldBeingEdited) {
+  Frame();
+  auto& edit = edits_[0];
+  edit.active = true;
+  edit.buffer = "C:\\half typed";
+  Frame();
+  EXPECT_EQ(edit.buffer, "C:\\half typed");
+
+  edit.active = false;
+  Frame();
+  EXPECT_EQ(edit.buffer, *paths_[0]);
+}
+
+TEST_F(OptionsViewTest, SteadyFramesDontAllocate) {
+  ASSERT_TRUE(allocation_counter::kEnabled);
+  Frame();
+  const auto allocations = allocation_counter::ThisThread();
+  bool rebuilt = false;
+  for (int i = 0; i < 100; i++) rebuilt |= Frame();
+  EXPECT_EQ(allocation_counter::ThisThread(), allocations);
+  EXPECT_FALSE(rebuilt);
+
+  // and the counter does see the rebuild after a change
+  settings_version_++;
+  Frame();
+  EXPECT_GT(allocation_counter::ThisThread(), allocations);
+}
+
+}  // namespace
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "PcmCache.h"
+
+namespace {
+
+constexpr uint32_t kChannels = 2;
+constexpr uint64_t kFrames = 64;
+// offset of Header::frame_count
+constexpr std::streamoff kFrameCountOffset = 48;
+
+class PcmCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = std::filesystem::path(testing::TempDir()) /
+                 testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::remove_all(directory_);
+    key_.path = "sounds/ready_check.wav";
+    key_.file_size = 1234;
+    key_.modified_time = 5678;
+    key_.content_hash = 0x1234;
+    key_.channels = kChannels;
+    key_.sample_rate = 48000;
+    samples_.resize(kFrames * kChannels);
+    for (size_t i = 0; i < samples_.size(); i++) samples_[i] = i / 128.0f;
+    analysis_.frame_count = kFrames;
+    analysis_.first_sound_frame = 1;
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory_); }
+
+  std::filesystem::path EntryPath() const {
+    for (const auto& file : std::filesystem::directory_iterator(directory_)) {
+      if (file.path().extension() == ".pcm") return file.path();
+    }
+    return {};
+  }
+
+  std::filesystem::path directory_;
+  PcmCacheKey key_;
+  std::vector<float> samples_;
+  PcmAnalysis analysis_;
+};
+
+TEST_F(PcmCacheTest, FindsStoredEntry) {
+  PcmCache cache(directory_, 1 << 20);
+  ASSERT_TRUE(cache.Store(key_, samples_.data(), kFrames, analysis_));
+
+  const auto entry = cache.Find(key_);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(entry->frame_count, kFrames);
+  EXPECT_EQ(entry->analysis.first_sound_frame, 1u);
+  EXPECT_EQ(std::memcmp(entry->samples, samples_.data(),
+                        samples_.size() * sizeof(float)),
+            0);
+  // nothing left behind by the write
+  EXPECT_FALSE(std::filesystem::exists(EntryPath().string() + ".tmp"));
+}
+
+TEST_F(PcmCacheTest, MissesOtherFormat) {
+  PcmCache cache(directory_, 1 << 20);
+  ASSERT_TRUE(cache.Store(key_, samples_.data(), kFrames, analysis_));
+
+  key_.sample_rate = 44100;
+  EXPECT_FALSE(cache.Find(key_));
+}
+
+TEST_F(PcmCacheTest, RejectsTruncatedEntry) {
+  PcmCache cache(directory_, 1 << 20);
+  ASSERT_TRUE(cache.Store(key_, samples_.data(), kFrames, analysis_));
+  const auto path = EntryPath();
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+
+  EXPECT_FALSE(cache.Find(key_));
+}
+
+TEST_F(PcmCacheTest, RejectsFrameCountDisagreeingWithSize) {
+  PcmCache cache(directory_, 1 << 20);
+  ASSERT_TRUE(cache.Store(key_, samples_.data(), kFrames, analysis_));
+  const auto path = EntryPath();
+
+  // large enough that frame_count * channels * sizeof(float) wraps around to
+  // the real sample bytes
+  const uint64_t frame_count = kFrames + (1ull << 61);
+  {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(kFrameCountOffset);
+    file.write(reinterpret_cast<const char*>(&frame_count),
+               sizeof(frame_count));
+  }
+
+  EXPECT_FALSE(cache.Find(key_));
+}
+
+}  // namespace
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <initializer_list>
+#include <vector>
+
+#include "ReadyCheckTracker.h"
+#include "TestSquad.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+using test::Left;
+using test::User;
+
+constexpr char kSelf[] = "Self.1234";
+
+// Records the alerts instead of playing them.
+class RecordingSinks final : public AudioSink, public WindowSink {
+ public:
+  void Play(const SoundEvent event) override { sounds.push_back(event); }
+  void FlashWindow() override { flashes++; }
+
+  std::vector<SoundEvent> sounds;
+  int flashes = 0;
+};
+
+class ReadyCheckTrackerTest : public testing::Test {
+ protected:
+  ReadyCheckTrackerTest() {
+    clock_.Set(ClockSink::Clock::time_point{} + 1h);
+    tracker_.SetConfig({.flash_window = true,
+                        .ready_check_nag = true,
+                        .ready_check_nag_interval_seconds = 5.0f});
+  }
+
+  SquadTransition Apply(std::initializer_list<UserDelta> users) {
+    const std::vector<UserDelta> batch(users);
+    return tracker_.ApplyBatch(batch.data(), batch.size(), kSelf);
+  }
+
+  // a leader and two members, self one of the members
+  void JoinSquad() {
+    Apply({User(kSelf, SquadRole::Member, 0),
+           User("Leader.1", SquadRole::SquadLeader, 0),
+           User("Member.1", SquadRole::Member, 0)});
+    sinks_.sounds.clear();
+    sinks_.flashes = 0;
+  }
+
+  void StartCheck() {
+    Apply({User("Leader.1", SquadRole::SquadLeader, 0, true)});
+  }
+
+  void Advance(const ClockSink::Clock::duration duration) {
+    clock_.Set(clock_.Now() + duration);
+  }
+
+  RecordingSinks sinks_;
+  SimulatedClock clock_;
+  ReadyCheckTracker tracker_{sinks_, sinks_, clock_};
+};
+
+TEST_F(ReadyCheckTrackerTest, StartingACheckAlerts) {
+  JoinSquad();
+  StartCheck();
+  EXPECT_EQ(sinks_.sounds,
+            std::vector<SoundEvent>{SoundEvent::ReadyCheckStarted});
+  EXPECT_EQ(sinks_.flashes, 1);
+  EXPECT_TRUE(tracker_.State().InReadyCheck());
+  EXPECT_TRUE(tracker_.Snapshot()->in_ready_check);
+}
+
+TEST_F(ReadyCheckTrackerTest, CompletingACheckAlerts) {
+  JoinSquad();
+  StartCheck();
+  Apply({User(kSelf, SquadRole::Member, 0, true)});
+  Apply({User("Member.1", SquadRole::Member, 0, true)});
+  EXPECT_EQ(sinks_.sounds,
+            (std::vector<SoundEvent>{SoundEvent::ReadyCheckStarted,
+                                     SoundEvent::SquadReady}));
+  EXPECT_EQ(sinks_.flashes, 2);
+  EXPECT_FALSE(tracker_.State().InReadyCheck());
+  EXPECT_EQ(tracker_.NextDeadline(), ReadyCheckTracker::kNoDeadline);
+}
+
+TEST_F(ReadyCheckTrackerTest, CancellingACheckAlerts) {
+  JoinSquad();
+  StartCheck();
+  Apply({User("Leader.1", SquadRole::SquadLeader, 0, false)});
+  EXPECT_EQ(sinks_.sounds,
+            (std::vector<SoundEvent>{SoundEvent::ReadyCheckStarted,
+                                     SoundEvent::ReadyCheckCancelled}));
+  EXPECT_FALSE(tracker_.State().InReadyCheck());
+  EXPECT_EQ(tracker_.NextDeadline(), ReadyCheckTracker::kNoDeadline);
+}
+
+TEST_F(ReadyCheckTrackerTest, SelfLeavingResetsTheCheck) {
+  JoinSquad();
+  StartCheck();
+  Apply({Left(kSelf)});
+  EXPECT_EQ(sinks_.sounds.back(), SoundEvent::ReadyCheckCancelled);
+  EXPECT_FALSE(tracker_.State().InReadyCheck());
+  EXPECT_TRUE(tracker_.State().Players().Empty());
+  EXPECT_EQ(tracker_.NextDeadline(), ReadyCheckTracker::kNoDeadline);
+  EXPECT_TRUE(tracker_.Snapshot()->players.Empty());
+
+  // rejoining is not a join of anyone else
+  sinks_.sounds.clear();
+  JoinSquad();
+  EXPECT_TRUE(sinks_.sounds.empty());
+}
+
+TEST_F(ReadyCheckTrackerTest, ResetForgetsTheSquadQuietly) {
+  JoinSquad();
+  StartCheck();
+  sinks_.sounds.clear();
+  tracker_.Reset();
+  EXPECT_TRUE(sinks_.sounds.empty());
+  EXPECT_FALSE(tracker_.State().InReadyCheck());
+  EXPECT_TRUE(tracker_.State().Players().Empty());
+  EXPECT_EQ(tracker_.NextDeadline(), ReadyCheckTracker::kNoDeadline);
+  EXPECT_TRUE(tracker_.Snapshot()->players.Empty());
+  EXPECT_EQ(tracker_.Latency().CheckCount(), 1u);
+
+  // the squad coming back through later updates is not a join, someone who
+  // joined since is
+  Apply({User("Member.1", SquadRole::Member, 0)});
+  Apply({User("Leader.1", SquadRole::SquadLeader, 0)});
+  EXPECT_TRUE(sinks_.sounds.empty());
+  Apply({UserDelta::Make("Member.2", 1, SquadRole::Member, 0, false)});
+  EXPECT_EQ(sinks_.sounds, std::vector<SoundEvent>{SoundEvent::MemberJoined});
+
+  // and a new check is picked up again
+  sinks_.sounds.clear();
+  StartCheck();
+  EXPECT_EQ(sinks_.sounds,
+            std::vector<SoundEvent>{SoundEvent::ReadyCheckStarted});
+}
+
+TEST_F(ReadyCheckTrackerTest, NagsUntilSelfReadies) {
+  JoinSquad();
+  StartCheck();
+  const auto started = clock_.Now();
+  EXPECT_EQ(tracker_.NextDeadline(), started + 5s);
+  EXPECT_EQ(tracker_.ReadyCheckNagTime(), started + 5s);
+
+  Advance(4s);
+  EXPECT_FALSE(tracker_.Tick());
+  Advance(1s);
+  EXPECT_TRUE(tracker_.Tick());
+  EXPECT_EQ(sinks_.sounds.back(), SoundEvent::ReadyCheckNag);
+  EXPECT_EQ(tracker_.NextDeadline(), started + 10s);
+
+  Apply({User(kSelf, SquadRole::Member, 0, true)});
+  EXPECT_EQ(tracker_.NextDeadline(), ReadyCheckTracker::kNoDeadline);
+  Advance(10s);
+  EXPECT_FALSE(tracker_.Tick());
+}
+
+TEST_F(ReadyCheckTrackerTest, DisabledNagKeepsTheTimer) {
+  tracker_.SetConfig({.flash_window = false, .ready_check_nag = false});
+  JoinSquad();
+  StartCheck();
+  Advance(5s);
+  EXPECT_FALSE(tracker_.Tick());
+  EXPECT_EQ(sinks_.sounds,
+            std::vector<SoundEvent>{SoundEvent::ReadyCheckStarted});
+  EXPECT_EQ(sinks_.flashes, 0);
+  // enabling it mid check takes effect at the next deadline
+  tracker_.SetConfig({.ready_check_nag = true});
+  Advance(5s);
+  EXPECT_TRUE(tracker_.Tick());
+}
+
+TEST_F(ReadyCheckTrackerTest, ClampsNagInterval) {
+  for (const float interval : {0.0f, -1.0f, 0.0001f}) {
+    tracker_.SetConfig({.ready_check_nag = true,
+                        .ready_check_nag_interval_seconds = interval});
+    JoinSquad();
+    StartCheck();
+    EXPECT_EQ(tracker_.NextDeadline(), clock_.Now() + 100ms);
+
+    // at most one nag per tick, however late the tick
+    Advance(1s);
+    sinks_.sounds.clear();
+    EXPECT_TRUE(tracker_.Tick());
+    EXPECT_EQ(sinks_.sounds,
+              std::vector<SoundEvent>{SoundEvent::ReadyCheckNag});
+    EXPECT_EQ(tracker_.NextDeadline(), clock_.Now() + 100ms);
+    EXPECT_FALSE(tracker_.Tick());
+
+    Apply({Left(kSelf)});
+  }
+}
+
+TEST_F(ReadyCheckTrackerTest, MemberJoiningAlerts) {
+  JoinSquad();
+  Apply({User("Member.2", SquadRole::Member, 1)});
+  EXPECT_EQ(sinks_.sounds, std::vector<SoundEvent>{SoundEvent::MemberJoined});
+}
+
+TEST_F(ReadyCheckTrackerTest, RemovingAnInviteIsNotAJoin) {
+  JoinSquad();
+  const auto [invited, member] = test::CollidingNames();
+  Apply({User(invited, SquadRole::Invited)});
+  Apply({User(member, SquadRole::Member)});
+  sinks_.sounds.clear();
+  Apply({Left(invited)});
+  EXPECT_TRUE(sinks_.sounds.empty());
+}
+
+}  // namespace
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <string>
+
+#include "Roster.h"
+#include "TestSquad.h"
+
+namespace {
+
+int Insert(Roster& roster, const std::string& name, const SquadRole role,
+           const uint8_t subgroup = 0, const bool ready = false) {
+  bool inserted;
+  const int slot =
+      roster.FindOrInsert(name, Roster::HashAccountName(name), inserted);
+  if (slot != Roster::kNoSlot) roster.Update(slot, 0, role, subgroup, ready);
+  return slot;
+}
+
+int Find(const Roster& roster, const std::string& name) {
+  return roster.Find(name, Roster::HashAccountName(name));
+}
+
+bool Erase(Roster& roster, const std::string& name) {
+  return roster.Erase(name, Roster::HashAccountName(name));
+}
+
+TEST(RosterTest, NormalizesAccountNames) {
+  EXPECT_EQ(Roster::NormalizeAccountName(":Player.1234"), "Player.1234");
+  EXPECT_EQ(Roster::NormalizeAccountName("Player.1234"), "Player.1234");
+  EXPECT_EQ(Roster::NormalizeAccountName(nullptr), "");
+}
+
+TEST(RosterTest, FindsInsertedAndErasedUsers) {
+  Roster roster;
+  const int slot = Insert(roster, "Player.1234", SquadRole::Member);
+  ASSERT_NE(slot, Roster::kNoSlot);
+  EXPECT_EQ(Find(roster, "Player.1234"), slot);
+  EXPECT_EQ(roster.AccountName(slot), "Player.1234");
+
+  bool inserted;
+  EXPECT_EQ(roster.FindOrInsert("Player.1234",
+                                Roster::HashAccountName("Player.1234"),
+                                inserted),
+            slot);
+  EXPECT_FALSE(inserted);
+
+  EXPECT_TRUE(Erase(roster, "Player.1234"));
+  EXPECT_EQ(Find(roster, "Player.1234"), Roster::kNoSlot);
+  EXPECT_FALSE(Erase(roster, "Player.1234"));
+  EXPECT_TRUE(roster.Empty());
+}
+
+TEST(RosterTest, ErasingKeepsProbedUsersFindable) {
+  Roster roster;
+  const auto [first, second] = test::CollidingNames();
+  const int first_slot = Insert(roster, first, SquadRole::Invited);
+  const int second_slot = Insert(roster, second, SquadRole::Member);
+  ASSERT_NE(first_slot, second_slot);
+
+  EXPECT_TRUE(Erase(roster, first));
+  // shifted back into the freed slot
+  EXPECT_EQ(Find(roster, second), first_slot);
+  EXPECT_EQ(roster.Role(first_slot), SquadRole::Member);
+  EXPECT_EQ(roster.EligibleMask(), Roster::Mask{1} << first_slot);
+}
+
+TEST(RosterTest, EraseKeepsEveryOtherUserFindable) {
+  Roster roster;
+  for (int i = 0; i < 50; i++) {
+    ASSERT_NE(Insert(roster, "Player." + std::to_string(i), SquadRole::Member),
+              Roster::kNoSlot);
+  }
+  for (int i = 0; i < 50; i += 3) {
+    EXPECT_TRUE(Erase(roster, "Player." + std::to_string(i)));
+  }
+  for (int i = 0; i < 50; i++) {
+    EXPECT_EQ(Find(roster, "Player." + std::to_string(i)) != Roster::kNoSlot,
+              i % 3 != 0)
+        << i;
+  }
+  EXPECT_EQ(roster.Size(), 33u);
+  EXPECT_EQ(std::popcount(roster.EligibleMask()), 33);
+}
+
+TEST(RosterTest, RejectsUsersPastCapacity) {
+  Roster roster;
+  for (size_t i = 0; i < Roster::kCapacity; i++) {
+    ASSERT_NE(Insert(roster, "Player." + std::to_string(i), SquadRole::Member),
+              Roster::kNoSlot);
+  }
+  EXPECT_EQ(Insert(roster, "Player.Extra", SquadRole::Member),
+            Roster::kNoSlot);
+  EXPECT_EQ(roster.Size(), Roster::kCapacity);
+}
+
+TEST(RosterTest, TracksReadinessOfEligibleUsers) {
+  Roster roster;
+  Insert(roster, "Leader.1", SquadRole::SquadLeader, 0, true);
+  const int member = Insert(roster, "Member.1", SquadRole::Member, 1);
+  Insert(roster, "Invited.1", SquadRole::Invited, 1);
+
+  EXPECT_EQ(std::popcount(roster.EligibleMask()), 2);
+  EXPECT_EQ(roster.NotReadyCount(), 1u);
+  EXPECT_FALSE(roster.AllReady());
+  EXPECT_TRUE(roster.SubgroupReady(0));
+  EXPECT_FALSE(roster.SubgroupReady(1));
+
+  roster.Update(member, 0, SquadRole::Member, 1, true);
+  EXPECT_TRUE(roster.AllReady());
+  // invites don't count towards a ready subgroup
+  EXPECT_TRUE(roster.SubgroupReady(1));
+
+  roster.Clear();
+  EXPECT_TRUE(roster.Empty());
+  EXPECT_FALSE(roster.AllReady());
+}
+
+}  // namespace
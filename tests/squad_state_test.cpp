@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <initializer_list>
+#include <vector>
+
+#include "SquadState.h"
+#include "TestSquad.h"
+
+namespace {
+
+using test::Left;
+using test::User;
+
+constexpr char kSelf[] = "Self.1234";
+
+class SquadStateTest : public testing::Test {
+ protected:
+  SquadTransition Apply(std::initializer_list<UserDelta> users) {
+    const std::vector<UserDelta> batch(users);
+    return state_.ApplyBatch(batch.data(), batch.size(), kSelf,
+                             SquadState::Clock::now());
+  }
+
+  // self leads a squad of two members, split over two subgroups
+  void JoinSquad() {
+    Apply({User(kSelf, SquadRole::SquadLeader, 0),
+           User("Member.1", SquadRole::Member, 0),
+           User("Member.2", SquadRole::Member, 1),
+           User("Member.3", SquadRole::Member, 1)});
+  }
+
+  SquadState state_;
+};
+
+TEST_F(SquadStateTest, FirstSeenUsersRaiseNothing) {
+  // ready when first seen, eg. self joining mid check
+  const auto transition = Apply({User(kSelf, SquadRole::Member, 0, true),
+                                 User("Leader.1", SquadRole::SquadLeader, 0,
+                                      true)});
+  EXPECT_EQ(transition.event, SquadEvent::None);
+  EXPECT_EQ(transition.joined_members, 2u);
+  EXPECT_FALSE(state_.InReadyCheck());
+  EXPECT_EQ(state_.Players().Size(), 2u);
+}
+
+TEST_F(SquadStateTest, LeaderReadyingStartsACheck) {
+  JoinSquad();
+  const auto transition = Apply({User(kSelf, SquadRole::SquadLeader, 0, true)});
+  EXPECT_EQ(transition.event, SquadEvent::ReadyCheckStarted);
+  EXPECT_TRUE(state_.InReadyCheck());
+  EXPECT_TRUE(state_.SelfReadied());
+}
+
+TEST_F(SquadStateTest, WholeSquadReadyingInOneBatchCompletesOnce) {
+  JoinSquad();
+  Apply({User(kSelf, SquadRole::SquadLeader, 0, true)});
+  const auto transition = Apply({User("Member.1", SquadRole::Member, 0, true),
+                                 User("Member.2", SquadRole::Member, 1, true),
+                                 User("Member.3", SquadRole::Member, 1, true)});
+  EXPECT_EQ(transition.event, SquadEvent::ReadyCheckCompleted);
+  // the squad ready event covers the subgroups
+  EXPECT_EQ(transition.readied_subgroups, 0);
+  EXPECT_FALSE(state_.InReadyCheck());
+}
+
+TEST_F(SquadStateTest, SubgroupReadiesBeforeTheSquad) {
+  JoinSquad();
+  Apply({User(kSelf, SquadRole::SquadLeader, 0, true)});
+  auto transition = Apply({User("Member.2", SquadRole::Member, 1, true),
+                           User("Member.3", SquadRole::Member, 1, true)});
+  EXPECT_EQ(transition.event, SquadEvent::None);
+  EXPECT_EQ(transition.readied_subgroups, 1 << 1);
+  EXPECT_EQ(state_.SubgroupsReadied(), 1 << 1);
+
+  // only raised once per check
+  Apply({User("Member.3", SquadRole::Member, 1, false)});
+  transition = Apply({User("Member.3", SquadRole::Member, 1, true)});
+  EXPECT_EQ(transition.readied_subgroups, 0);
+}
+
+TEST_F(SquadStateTest, LeaderUnreadyingEndsTheCheck) {
+  JoinSquad();
+  Apply({User(kSelf, SquadRole::SquadLeader, 0, true)});
+  const auto transition = Apply({User(kSelf, SquadRole::SquadLeader, 0)});
+  EXPECT_EQ(transition.event, SquadEvent::ReadyCheckEnded);
+  EXPECT_FALSE(state_.InReadyCheck());
+}
+
+TEST_F(SquadStateTest, SelfLeavingResetsTheSquad) {
+  JoinSquad();
+  Apply({User(kSelf, SquadRole::SquadLeader, 0, true)});
+  const auto transition = Apply({Left(kSelf)});
+  EXPECT_EQ(transition.event, SquadEvent::ReadyCheckEnded);
+  EXPECT_FALSE(state_.InReadyCheck());
+  EXPECT_FALSE(state_.SelfReadied());
+  EXPECT_TRUE(state_.Players().Empty());
+}
+
+TEST_F(SquadStateTest, CountsJoinsAndPromotions) {
+  JoinSquad();
+  EXPECT_EQ(Apply({User("Invited.1", SquadRole::Invited)}).joined_members, 0u);
+  EXPECT_EQ(Apply({User("Invited.1", SquadRole::Member)}).joined_members, 1u);
+  EXPECT_EQ(Apply({User("Member.4", SquadRole::Member, 1)}).joined_members,
+            1u);
+  // a role change between member roles is not a join
+  EXPECT_EQ(Apply({User("Member.4", SquadRole::Lieutenant, 1)}).joined_members,
+            0u);
+  EXPECT_EQ(Apply({Left("Member.4")}).joined_members, 0u);
+}
+
+TEST_F(SquadStateTest, ErasingAnInviteIsNotAJoin) {
+  JoinSquad();
+  // the member is probed past the invite, and shifted into its slot when the
+  // invite goes
+  const auto [invited, member] = test::CollidingNames();
+  Apply({User(invited, SquadRole::Invited)});
+  Apply({User(member, SquadRole::Member)});
+  const auto transition = Apply({Left(invited)});
+  EXPECT_EQ(transition.joined_members, 0u);
+  EXPECT_EQ(state_.Players().Size(), 5u);
+}
+
+}  // namespace
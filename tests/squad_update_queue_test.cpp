@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SquadUpdateQueue.h"
+#include "TestSquad.h"
+
+namespace {
+
+using test::User;
+
+// Pushes a callback of count members named Member.<first>...
+bool PushMembers(SquadUpdateQueue& queue, const size_t count,
+                 const int first = 0) {
+  return queue.Push(count, [&](const size_t i) {
+    return User("Member." + std::to_string(first + i), SquadRole::Member);
+  });
+}
+
+// Sizes of the callbacks drained.
+std::vector<size_t> Drain(SquadUpdateQueue& queue) {
+  std::vector<size_t> sizes;
+  queue.Drain([&](const UserDelta* users, const size_t count) {
+    EXPECT_TRUE(users[count - 1].batch_end);
+    sizes.push_back(count);
+  });
+  return sizes;
+}
+
+class SquadUpdateQueueTest : public testing::Test {
+ protected:
+  // too large for the stack
+  std::unique_ptr<SquadUpdateQueue> queue_ =
+      std::make_unique<SquadUpdateQueue>();
+};
+
+TEST_F(SquadUpdateQueueTest, DeliversWholeCallbacksInOrder) {
+  EXPECT_TRUE(PushMembers(*queue_, 3));
+  EXPECT_TRUE(PushMembers(*queue_, 1, 3));
+  EXPECT_TRUE(PushMembers(*queue_, 0));
+  EXPECT_EQ(Drain(*queue_), (std::vector<size_t>{3, 1}));
+  EXPECT_TRUE(Drain(*queue_).empty());
+  EXPECT_FALSE(queue_->TakeResync());
+}
+
+TEST_F(SquadUpdateQueueTest, OverflowDropsTheCallbackAndFlagsAResync) {
+  // several full squads in one frame fit
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(PushMembers(*queue_, Roster::kCapacity, i * 100));
+  }
+  EXPECT_FALSE(PushMembers(*queue_, 1, 1000));
+  EXPECT_FALSE(PushMembers(*queue_, 1, 1001));
+
+  // what was queued before still arrives whole
+  EXPECT_EQ(Drain(*queue_), std::vector<size_t>(4, Roster::kCapacity));
+  // once for both dropped callbacks
+  EXPECT_TRUE(queue_->TakeResync());
+  EXPECT_FALSE(queue_->TakeResync());
+
+  EXPECT_TRUE(PushMembers(*queue_, 2));
+  EXPECT_EQ(Drain(*queue_), std::vector<size_t>{2});
+  EXPECT_FALSE(queue_->TakeResync());
+}
+
+}  // namespace
@@ -0,0 +1,125 @@
+// Microbenchmarks for the mixing cost of the alert sounds: a device-less
+// miniaudio engine, set up like AudioPlayer's, renders looping sounds into an
+// OfflineOutput in 10ms periods like the device thread does. Every benchmark
+// reports CPU time per second of audio mixed ("cpu/audio_second").
+//
+// usage: squad_ready_audio_bench [google benchmark flags]
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <numbers>
+#include <vector>
+
+#include "OfflineOutput.h"
+#include "miniaudio/extras/miniaudio_split/miniaudio.h"
+
+namespace {
+
+constexpr ma_uint32 kChannels = 2;
+constexpr ma_uint32 kSampleRate = 48000;
+constexpr std::chrono::milliseconds kPeriod{10};
+
+// An engine playing voices looping copies of a one second mono tone, the
+// format the alert sounds are decoded to.
+class Mixer {
+ public:
+  explicit Mixer(const int voices) {
+    auto engine_config = ma_engine_config_init();
+    engine_config.noDevice = MA_TRUE;
+    engine_config.channels = kChannels;
+    engine_config.sampleRate = kSampleRate;
+    ma_engine_init(&engine_config, &engine_);
+
+    tone_.resize(kSampleRate);
+    for (size_t i = 0; i < tone_.size(); i++) {
+      tone_[i] = 0.1f * static_cast<float>(std::sin(
+                            2 * std::numbers::pi * 440 * i / kSampleRate));
+    }
+    voices_.resize(voices);
+    for (auto& voice : voices_) {
+      // every buffer reads the same samples with its own cursor
+      auto buffer_config = ma_audio_buffer_config_init(
+          ma_format_f32, 1, tone_.size(), tone_.data(), nullptr);
+      buffer_config.sampleRate = kSampleRate;
+      ma_audio_buffer_init(&buffer_config, &voice.buffer);
+      ma_sound_init_from_data_source(&engine_, &voice.buffer, 0, nullptr,
+                                     &voice.sound);
+      ma_sound_set_looping(&voice.sound, MA_TRUE);
+      ma_sound_start(&voice.sound);
+    }
+  }
+  Mixer(const Mixer&) = delete;
+  Mixer& operator=(const Mixer&) = delete;
+  ~Mixer() {
+    for (auto& voice : voices_) {
+      ma_sound_uninit(&voice.sound);
+      ma_audio_buffer_uninit(&voice.buffer);
+    }
+    ma_engine_uninit(&engine_);
+  }
+
+  OfflineOutput::Render Render() {
+    return [this](float* frames, const uint32_t frame_count) {
+      ma_engine_read_pcm_frames(&engine_, frames, frame_count, nullptr);
+    };
+  }
+
+ private:
+  struct Voice {
+    ma_audio_buffer buffer;
+    ma_sound sound;
+  };
+
+  ma_engine engine_;
+  std::vector<float> tone_;
+  // sounds point into their voice, so never resized after construction
+  std::vector<Voice> voices_;
+};
+
+void Report(benchmark::State& state, const OfflineOutput& output) {
+  state.SetItemsProcessed(static_cast<int64_t>(output.FramesRendered()));
+  const auto audio_seconds =
+      static_cast<double>(output.FramesRendered()) / kSampleRate;
+  state.counters["cpu/audio_second"] = benchmark::Counter(
+      audio_seconds, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+// Mixing voices sounds at once, the cost of a ready check alert overlapping
+// its retriggers.
+void BM_Mix(benchmark::State& state) {
+  Mixer mixer(static_cast<int>(state.range(0)));
+  OfflineOutput output(kChannels, kSampleRate, mixer.Render());
+  for (auto _ : state) {
+    output.Advance(kPeriod);
+  }
+  Report(state, output);
+}
+BENCHMARK(BM_Mix)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+
+// The same mix written to a WAV file, what recording the output costs on top.
+void BM_MixToFile(benchmark::State& state) {
+  const auto path =
+      std::filesystem::temp_directory_path() / "squad_ready_audio_bench.wav";
+  Mixer mixer(static_cast<int>(state.range(0)));
+  {
+    OfflineOutput output(kChannels, kSampleRate, mixer.Render());
+    if (!output.OpenFile(path)) {
+      state.SkipWithError("failed to create the WAV file");
+      return;
+    }
+    for (auto _ : state) {
+      output.Advance(kPeriod);
+    }
+    Report(state, output);
+  }
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_MixToFile)->Arg(1)->Arg(4);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""Converts the bundled sounds into the form embedded in the DLL.
+
+  pcm    f32 PCM arrays in EmbeddedSounds.h, played without any decoding.
+  adpcm  4-bit IMA ADPCM WAV files for the WAVE resources, about a quarter of
+         the size of the 16-bit originals, decoded by miniaudio while playing.
+
+Run by the SoundEncoding build property in arcdps-squad-ready-plugin.vcxproj,
+and by hand to compare the variants:
+
+  python tools/embed_sounds.py pcm out squad_ready/sounds/*.wav
+"""
+
+import argparse
+import pathlib
+import struct
+import sys
+import wave
+
+# Standard IMA ADPCM tables.
+INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8] * 2
+STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+    45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190,
+    209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499,
+    2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845,
+    8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350,
+    22385, 24623, 27086, 29794, 32767,
+]
+
+# Bytes per ADPCM block per channel, the usual choice for speech.
+ADPCM_BLOCK_BYTES = 256
+WAVE_FORMAT_IMA_ADPCM = 0x0011
+
+
+def write_if_changed(path, data):
+    """Leaves unchanged outputs alone so they do not force a rebuild."""
+    if not path.exists() or path.read_bytes() != data:
+        path.write_bytes(data)
+
+
+def read_wav(path):
+    """Returns (channels, sample_rate, interleaved int16 samples)."""
+    with wave.open(str(path), "rb") as wav:
+        if wav.getsampwidth() != 2:
+            sys.exit(f"{path}: only 16-bit PCM WAV is supported")
+        frames = wav.readframes(wav.getnframes())
+        samples = struct.unpack(f"<{len(frames) // 2}h", frames)
+        return wav.getnchannels(), wav.getframerate(), samples
+
+
+def identifier(path):
+    """ready_check.wav -> ReadyCheck"""
+    return "".join(part.capitalize() for part in path.stem.split("_"))
+
+
+class AdpcmChannel:
+    def __init__(self):
+        self.predictor = 0
+        self.index = 0
+
+    def encode(self, sample):
+        step = STEP_TABLE[self.index]
+        diff = sample - self.predictor
+        nibble = 0
+        if diff < 0:
+            nibble = 8
+            diff = -diff
+        delta = step >> 3
+        if diff >= step:
+            nibble |= 4
+            diff -= step
+            delta += step
+        step >>= 1
+        if diff >= step:
+            nibble |= 2
+            diff -= step
+            delta += step
+        step >>= 1
+        if diff >= step:
+            nibble |= 1
+            delta += step
+        # track the decoder exactly so errors do not accumulate
+        self.predictor += -delta if nibble & 8 else delta
+        self.predictor = max(-32768, min(32767, self.predictor))
+        self.index = max(0, min(88, self.index + INDEX_TABLE[nibble]))
+        return nibble
+
+
+def encode_adpcm(channels, sample_rate, samples):
+    """Encodes to a complete IMA ADPCM WAV file, as dr_wav reads it."""
+    frame_count = len(samples) // channels
+    block_align = ADPCM_BLOCK_BYTES * channels
+    # the header sample, then two per byte after the 4 byte header
+    frames_per_block = (ADPCM_BLOCK_BYTES - 4) * 2 + 1
+    state = [AdpcmChannel() for _ in range(channels)]
+
+    data = bytearray()
+    for start in range(0, frame_count, frames_per_block):
+        block = bytearray()
+        for c in range(channels):
+            first = samples[start * channels + c] if start < frame_count else 0
+            state[c].predictor = first
+            block += struct.pack("<hBB", first, state[c].index, 0)
+        # channels take turns with 4 bytes (8 samples) each
+        nibbles = [[] for _ in range(channels)]
+        for i in range(1, frames_per_block):
+            frame = start + i
+            for c in range(channels):
+                sample = (samples[frame * channels + c]
+                          if frame < frame_count else 0)
+                nibbles[c].append(state[c].encode(sample))
+        for group in range(0, frames_per_block - 1, 8):
+            for c in range(channels):
+                chunk = nibbles[c][group:group + 8]
+                for low, high in zip(chunk[0::2], chunk[1::2]):
+                    block.append(low | high << 4)
+        data += block
+
+    fmt = struct.pack("<HHIIHHHH", WAVE_FORMAT_IMA_ADPCM, channels,
+                      sample_rate,
+                      sample_rate * block_align // frames_per_block,
+                      block_align, 4, 2, frames_per_block)
+    fact = struct.pack("<I", frame_count)
+    body = (b"WAVE" + b"fmt " + struct.pack("<I", len(fmt)) + fmt +
+            b"fact" + struct.pack("<I", len(fact)) + fact +
+            b"data" + struct.pack("<I", len(data)) + data)
+    return b"RIFF" + struct.pack("<I", len(body)) + body
+
+
+def write_adpcm(sounds, out):
+    for path in sounds:
+        channels, sample_rate, samples = read_wav(path)
+        encoded = encode_adpcm(channels, sample_rate, samples)
+        write_if_changed(out / path.name, encoded)
+        print(f"{path.name}: {path.stat().st_size} bytes WAV -> "
+              f"{len(encoded)} bytes IMA ADPCM")
+
+
+def write_pcm(sounds, out):
+    lines = [
+        "// Generated by tools/embed_sounds.py, do not edit.",
+        "#pragma once",
+        "",
+        '#include "EmbeddedSound.h"',
+        "",
+        "namespace embedded_sounds {",
+    ]
+    for path in sounds:
+        channels, sample_rate, samples = read_wav(path)
+        name = identifier(path)
+        # int16 / 32768 is exact in a float, and repr round trips it
+        values = [f"{sample / 32768!r}f" for sample in samples]
+        lines.append("")
+        lines.append(f"inline constexpr float k{name}Samples[] = {{")
+        for i in range(0, len(values), 8):
+            lines.append("    " + ", ".join(values[i:i + 8]) + ",")
+        lines.append("};")
+        lines.append(f"inline constexpr EmbeddedSound k{name} = {{")
+        lines.append(f"    k{name}Samples, {len(samples) // channels}, "
+                     f"{channels}, {sample_rate}}};")
+        print(f"{path.name}: {path.stat().st_size} bytes WAV -> "
+              f"{len(samples) * 4} bytes f32")
+    lines.append("")
+    lines.append("}  // namespace embedded_sounds")
+    header = "\n".join(lines) + "\n"
+    write_if_changed(out / "EmbeddedSounds.h", header.encode())
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("encoding", choices=["pcm", "adpcm"])
+    parser.add_argument("out", type=pathlib.Path)
+    parser.add_argument("sounds", type=pathlib.Path, nargs="+")
+    args = parser.parse_args()
+
+    args.out.mkdir(parents=True, exist_ok=True)
+    if args.encoding == "pcm":
+        write_pcm(args.sounds, args.out)
+    else:
+        write_adpcm(args.sounds, args.out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,213 @@
+// Microbenchmarks for the squad update hot path: converting and queueing the
+// unofficial extras callback, applying it to the roster and raising the ready
+// check alerts. Every benchmark reports the time per user update ("time/update") and
+// heap allocations per squad callback ("allocs/callback").
+//
+// usage: squad_ready_bench [google benchmark flags]
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "ReadyCheckTracker.h"
+#include "SquadUpdateQueue.h"
+
+namespace {
+
+size_t allocation_count = 0;
+
+}  // namespace
+
+// Count every heap allocation made by the process, the benchmarks only read
+// the difference across their timed loop.
+void* operator new(const size_t size) {
+  allocation_count++;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+  throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+constexpr char kSelfAccountName[] = "self.1234";
+
+class NullSinks final : public AudioSink, public WindowSink {
+ public:
+  void Play(SoundEvent) override {}
+  void FlashWindow() override {}
+};
+
+// What unofficial extras hands to the squad update callback.
+struct RawUser {
+  std::string account_name;
+  int64_t join_time;
+  SquadRole role;
+  uint8_t subgroup;
+  bool ready;
+};
+
+// A squad with self as the leader in subgroup 1 and five members per
+// subgroup.
+std::vector<RawUser> MakeSquad(const int size) {
+  std::vector<RawUser> squad;
+  for (int i = 0; i < size; i++) {
+    squad.push_back({i == 0 ? ":" + std::string(kSelfAccountName)
+                            : ":player." + std::to_string(1000 + i),
+                     1600000000 + i,
+                     i == 0 ? SquadRole::SquadLeader : SquadRole::Member,
+                     static_cast<uint8_t>(i / 5), false});
+  }
+  return squad;
+}
+
+UserDelta ToDelta(const RawUser& user) {
+  return UserDelta::Make(user.account_name.c_str(), user.join_time, user.role,
+                         user.subgroup, user.ready);
+}
+
+std::vector<UserDelta> ToDeltas(const std::vector<RawUser>& users) {
+  std::vector<UserDelta> deltas;
+  for (const auto& user : users) deltas.push_back(ToDelta(user));
+  if (!deltas.empty()) deltas.back().batch_end = true;
+  return deltas;
+}
+
+// Owns a tracker and the fakes it needs, and keeps the counters.
+struct Fixture {
+  NullSinks sinks;
+  SimulatedClock clock;
+  ReadyCheckTracker tracker{sinks, sinks, clock};
+  size_t callbacks = 0;
+  size_t updates = 0;
+  size_t allocations_before = allocation_count;
+
+  void Apply(const UserDelta* users, const size_t count) {
+    benchmark::DoNotOptimize(tracker.ApplyBatch(users, count, kSelfAccountName));
+    callbacks++;
+    updates += count;
+  }
+  void Apply(const std::vector<UserDelta>& users) {
+    Apply(users.data(), users.size());
+  }
+
+  void Report(benchmark::State& state) const {
+    state.SetItemsProcessed(static_cast<int64_t>(updates));
+    // an inverted rate of updates is time per update, printed as e.g. 75ns
+    state.counters["time/update"] = benchmark::Counter(
+        static_cast<double>(updates),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["allocs/callback"] =
+        callbacks == 0 ? 0.0
+                       : static_cast<double>(allocation_count -
+                                             allocations_before) /
+                             callbacks;
+  }
+};
+
+// Steady state squad updates through the same path as SquadTracker: convert
+// the callback on the extras thread, queue it, pop it on the render thread
+// and apply it. Every member flips their ready state each callback, with the
+// leader never readied so no ready check is started.
+void BM_UpdateUsers(benchmark::State& state) {
+  const auto squad = MakeSquad(static_cast<int>(state.range(0)));
+  Fixture fixture;
+  fixture.Apply(ToDeltas(squad));
+
+  std::vector<RawUser> toggled = squad;
+  for (size_t i = 1; i < toggled.size(); i++) toggled[i].ready = true;
+  const std::array<const std::vector<RawUser>*, 2> updates{&toggled, &squad};
+
+  SquadUpdateQueue queue;
+  size_t round = 0;
+  fixture.callbacks = fixture.updates = 0;
+  fixture.allocations_before = allocation_count;
+  for (auto _ : state) {
+    const auto& users = *updates[round++ & 1];
+    queue.Push(users.size(), [&](const size_t i) { return ToDelta(users[i]); });
+    queue.Drain([&](const UserDelta* batch, const size_t batch_size) {
+      fixture.Apply(batch, batch_size);
+    });
+  }
+  fixture.Report(state);
+}
+BENCHMARK(BM_UpdateUsers)->Arg(5)->Arg(10)->Arg(50);
+
+// A full ready check: the leader starts it, members ready up one callback at
+// a time until the squad is ready, then the leader ends it and everyone is
+// reset in one bulk update.
+void BM_ReadyCheckCycle(benchmark::State& state) {
+  const auto squad = MakeSquad(static_cast<int>(state.range(0)));
+  Fixture fixture;
+  fixture.Apply(ToDeltas(squad));
+
+  std::vector<UserDelta> readying;
+  for (const auto& user : squad) {
+    auto ready = user;
+    ready.ready = true;
+    readying.push_back(ToDelta(ready));
+    readying.back().batch_end = true;
+  }
+  const auto reset = ToDeltas(squad);
+
+  fixture.callbacks = fixture.updates = 0;
+  fixture.allocations_before = allocation_count;
+  for (auto _ : state) {
+    for (const auto& user : readying) fixture.Apply(&user, 1);
+    fixture.Apply(reset);
+  }
+  fixture.Report(state);
+}
+BENCHMARK(BM_ReadyCheckCycle)->Arg(5)->Arg(10)->Arg(50);
+
+// Everyone but self joins in one callback and leaves in the next, like a
+// squad forming and breaking up between encounters.
+void BM_JoinLeaveChurn(benchmark::State& state) {
+  const auto squad = MakeSquad(static_cast<int>(state.range(0)));
+  Fixture fixture;
+  fixture.Apply(ToDeltas({squad.front()}));
+
+  const std::vector<RawUser> members(squad.begin() + 1, squad.end());
+  auto leaving = members;
+  for (auto& user : leaving) user.role = SquadRole::None;
+  const auto join = ToDeltas(members);
+  const auto leave = ToDeltas(leaving);
+
+  fixture.callbacks = fixture.updates = 0;
+  fixture.allocations_before = allocation_count;
+  for (auto _ : state) {
+    fixture.Apply(join);
+    fixture.Apply(leave);
+  }
+  fixture.Report(state);
+}
+BENCHMARK(BM_JoinLeaveChurn)->Arg(5)->Arg(10)->Arg(50);
+
+// Self leaving a full squad, which clears the whole roster, followed by the
+// rejoin callback that repopulates it.
+void BM_SelfLeaveReset(benchmark::State& state) {
+  const auto squad = MakeSquad(static_cast<int>(state.range(0)));
+  Fixture fixture;
+  auto self_leaving = squad.front();
+  self_leaving.role = SquadRole::None;
+  const auto join = ToDeltas(squad);
+  const auto leave = ToDeltas({self_leaving});
+
+  fixture.callbacks = fixture.updates = 0;
+  fixture.allocations_before = allocation_count;
+  for (auto _ : state) {
+    fixture.Apply(join);
+    fixture.Apply(leave);
+  }
+  fixture.Report(state);
+}
+BENCHMARK(BM_SelfLeaveReset)->Arg(5)->Arg(10)->Arg(50);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,251 @@
+// Replays a squad update trace recorded from the Squad Ready debug window
+// through ReadyCheckTracker with a simulated clock, printing the ready check
+// events and alerts it raises and how long each update callback took to apply.
+//
+// usage: squad_ready_replay [--self <account>] [--repeat <n>] [--nag <seconds>]
+//                           [--quiet] <trace>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ReadyCheckTracker.h"
+#include "Trace.h"
+
+namespace {
+
+struct Options {
+  std::string trace_path;
+  std::string self_account_name;
+  bool self_account_override = false;
+  int repeat = 1;
+  // nag interval in seconds, 0 disables the nag
+  float nag_interval_seconds = 0.0f;
+  bool quiet = false;
+};
+
+// Counts the alerts instead of playing them.
+class CountingSinks final : public AudioSink, public WindowSink {
+ public:
+  void Play(const SoundEvent event) override {
+    sounds[static_cast<size_t>(event)]++;
+  }
+  void FlashWindow() override { flashes++; }
+
+  std::array<size_t, kSoundEvents> sounds{};
+  size_t flashes = 0;
+};
+
+struct Callback {
+  uint64_t timestamp_us;
+  std::vector<UserDelta> users;
+};
+
+void PrintUsage() {
+  std::fprintf(stderr,
+               "usage: squad_ready_replay [--self <account>] [--repeat <n>] "
+               "[--nag <seconds>] [--quiet] <trace>\n");
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--self") == 0 && i + 1 < argc) {
+      options.self_account_name = Roster::NormalizeAccountName(argv[++i]);
+      options.self_account_override = true;
+    } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      options.repeat = std::max(1, std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--nag") == 0 && i + 1 < argc) {
+      options.nag_interval_seconds =
+          std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+    } else if (std::strcmp(argv[i], "--quiet") == 0) {
+      options.quiet = true;
+    } else if (argv[i][0] != '-' && options.trace_path.empty()) {
+      options.trace_path = argv[i];
+    } else {
+      return false;
+    }
+  }
+  return !options.trace_path.empty();
+}
+
+const char* EventName(const SquadEvent event) {
+  switch (event) {
+    case SquadEvent::ReadyCheckStarted:
+      return "ready check started";
+    case SquadEvent::ReadyCheckCompleted:
+      return "squad ready";
+    case SquadEvent::ReadyCheckEnded:
+      return "ready check ended";
+    default:
+      return "none";
+  }
+}
+
+double Seconds(const uint64_t timestamp_us) { return timestamp_us / 1e6; }
+
+double Seconds(const ReadyCheckTracker::Clock::time_point time) {
+  return std::chrono::duration<double>(time.time_since_epoch()).count();
+}
+
+uint64_t Percentile(const std::vector<uint64_t>& sorted, const double p) {
+  if (sorted.empty()) return 0;
+  const auto index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void PrintLatency(const ReadyLatency& latency) {
+  const auto& squad = latency.SquadHistogram();
+  std::printf("squad ready after (ms): p50 %u p90 %u p99 %u max %u (%u checks)\n",
+              squad.Percentile(0.5), squad.Percentile(0.9),
+              squad.Percentile(0.99), squad.Max(), squad.Count());
+  latency.ForEachAccount([](const ReadyLatency::Account& account) {
+    const auto& histogram = account.histogram;
+    std::printf("  %-32s readied %u times, p50 %ums p90 %ums max %ums\n",
+                account.AccountName().data(), histogram.Count(),
+                histogram.Percentile(0.5), histogram.Percentile(0.9),
+                histogram.Max());
+  });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    PrintUsage();
+    return 2;
+  }
+
+  trace::Reader reader;
+  if (!reader.Open(options.trace_path)) {
+    std::fprintf(stderr, "%s: %s\n", options.trace_path.c_str(),
+                 reader.Error().c_str());
+    return 1;
+  }
+
+  // Load everything up front so file I/O is not part of the timings.
+  std::vector<Callback> callbacks;
+  size_t user_count = 0;
+  trace::Record record;
+  while (reader.Next(record)) {
+    if (record.type == trace::RecordType::SelfAccount) {
+      if (!options.self_account_override) {
+        options.self_account_name =
+            Roster::NormalizeAccountName(record.self_account_name.c_str());
+      }
+      continue;
+    }
+    auto& callback = callbacks.emplace_back();
+    callback.timestamp_us = record.timestamp_us;
+    for (size_t i = 0; i < record.users.size(); i++) {
+      const auto& user = record.users[i];
+      auto delta = UserDelta::Make(user.account_name.c_str(), user.join_time,
+                                   static_cast<SquadRole>(user.role),
+                                   user.subgroup, user.ready);
+      delta.batch_end = i + 1 == record.users.size();
+      callback.users.push_back(delta);
+    }
+    user_count += record.users.size();
+  }
+  if (!reader.Error().empty()) {
+    std::fprintf(stderr, "%s: %s\n", options.trace_path.c_str(),
+                 reader.Error().c_str());
+    return 1;
+  }
+
+  std::printf("trace: %s\nself: %s\ncallbacks: %zu, user updates: %zu\n",
+              options.trace_path.c_str(), options.self_account_name.c_str(),
+              callbacks.size(), user_count);
+
+  std::vector<uint64_t> callback_ns;
+  callback_ns.reserve(callbacks.size() * options.repeat);
+  uint64_t total_ns = 0;
+  CountingSinks sinks;
+  for (int pass = 0; pass < options.repeat; pass++) {
+    sinks = {};
+    SimulatedClock clock;
+    ReadyCheckTracker tracker(sinks, sinks, clock);
+    ReadyCheckConfig config;
+    config.ready_check_nag = options.nag_interval_seconds > 0.0f;
+    if (config.ready_check_nag) {
+      config.ready_check_nag_interval_seconds = options.nag_interval_seconds;
+    }
+    tracker.SetConfig(config);
+
+    const bool report = pass == 0 && !options.quiet;
+    const auto& state = tracker.State();
+    for (const auto& callback : callbacks) {
+      const auto now = ReadyCheckTracker::Clock::time_point(
+          std::chrono::microseconds(callback.timestamp_us));
+
+      // run any timers that would have come due between the two callbacks
+      while (tracker.NextDeadline() <= now) {
+        clock.Set(tracker.NextDeadline());
+        if (tracker.Tick() && report) {
+          std::printf("[%10.3fs] nag\n", Seconds(clock.Now()));
+        }
+      }
+      clock.Set(now);
+
+      const auto begin = std::chrono::steady_clock::now();
+      const auto transition =
+          tracker.ApplyBatch(callback.users.data(), callback.users.size(),
+                             options.self_account_name);
+      const auto end = std::chrono::steady_clock::now();
+
+      const auto ns = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+              .count());
+      callback_ns.push_back(ns);
+      total_ns += ns;
+
+      if (!report) continue;
+      if (transition.event != SquadEvent::None) {
+        std::printf("[%10.3fs] %s (%zu/%zu ready)\n",
+                    Seconds(callback.timestamp_us),
+                    EventName(transition.event),
+                    static_cast<size_t>(std::popcount(
+                        state.Players().EligibleMask() &
+                        state.Players().ReadyMask())),
+                    static_cast<size_t>(
+                        std::popcount(state.Players().EligibleMask())));
+      }
+      Roster::ForEachSlot(transition.readied_subgroups, [&](const int i) {
+        std::printf("[%10.3fs] subgroup %d ready\n",
+                    Seconds(callback.timestamp_us), i + 1);
+      });
+      if (transition.dropped_users != 0) {
+        std::printf("[%10.3fs] roster full, dropped %u users\n",
+                    Seconds(callback.timestamp_us), transition.dropped_users);
+      }
+    }
+    if (report) PrintLatency(tracker.Latency());
+  }
+
+  std::printf("alerts: %zu window flashes\n", sinks.flashes);
+  for (size_t i = 0; i < kSoundEvents; i++) {
+    std::printf("  %-24s %zu sounds\n",
+                SoundEventName(static_cast<SoundEvent>(i)), sinks.sounds[i]);
+  }
+
+  std::sort(callback_ns.begin(), callback_ns.end());
+  const size_t updates = user_count * options.repeat;
+  std::printf(
+      "apply time per callback (ns): min %llu p50 %llu p99 %llu max %llu "
+      "mean %.1f\n",
+      static_cast<unsigned long long>(Percentile(callback_ns, 0.0)),
+      static_cast<unsigned long long>(Percentile(callback_ns, 0.5)),
+      static_cast<unsigned long long>(Percentile(callback_ns, 0.99)),
+      static_cast<unsigned long long>(Percentile(callback_ns, 1.0)),
+      callback_ns.empty() ? 0.0
+                          : static_cast<double>(total_ns) / callback_ns.size());
+  std::printf("apply time per user update (ns): %.1f\n",
+              updates == 0 ? 0.0 : static_cast<double>(total_ns) / updates);
+  return 0;
+}